@@ -0,0 +1,275 @@
+#pragma once
+
+// Shared helpers for the plib benchmarks: allocation tracking, peak RSS growth and key set generation.
+// Include this from exactly one translation unit per benchmark executable, it replaces the global operator new.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#    define NOMINMAX
+#    include <windows.h>
+#    include <psapi.h>
+#else
+#    include <sys/resource.h>
+#endif
+#ifdef __linux__
+#    include <malloc.h>
+#    include <sstream>
+#endif
+
+namespace plib::bench {
+
+struct alloc_stats {
+    std::atomic<std::size_t> count = 0;
+    std::atomic<std::size_t> live_bytes = 0;
+};
+
+inline alloc_stats& allocations() {
+    static alloc_stats stats;
+    return stats;
+}
+
+// Snapshot of the allocation counters, used to measure the allocations done inside a scope.
+struct alloc_snapshot {
+    std::size_t count = allocations().count.load(std::memory_order_relaxed);
+    std::size_t live_bytes = allocations().live_bytes.load(std::memory_order_relaxed);
+
+    std::size_t count_since() const {
+        return allocations().count.load(std::memory_order_relaxed) - count;
+    }
+
+    std::ptrdiff_t bytes_since() const {
+        return static_cast<std::ptrdiff_t>(allocations().live_bytes.load(std::memory_order_relaxed))
+            - static_cast<std::ptrdiff_t>(live_bytes);
+    }
+};
+
+// Peak resident set size of the process in bytes.
+inline std::size_t peak_rss() {
+#if defined(__linux__)
+    // VmHWM instead of ru_maxrss, since only the former can be reset (see reset_peak_rss).
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            std::size_t kb = 0;
+            std::istringstream(line.substr(6)) >> kb;
+            return kb * 1024;
+        }
+    }
+    return 0;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#    ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#    else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#    endif
+#endif
+}
+
+// Reset the peak to the current resident set size. Only supported on Linux, elsewhere the peak covers the whole process.
+// Free heap memory is returned to the OS first, otherwise memory released by an earlier benchmark stays resident
+// and reusing it would not show up as growth.
+inline void reset_peak_rss() {
+#ifdef __linux__
+#    ifdef __GLIBC__
+    malloc_trim(0);
+#    endif
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+// How far the peak RSS rises above its value at construction. The process-wide peak would carry over from whatever
+// ran before (including containers cached by other benchmarks), so it is reset first where the OS allows it.
+// Without a reset only growth beyond the earlier peak is visible.
+struct rss_snapshot {
+    std::size_t baseline = 0;
+
+    rss_snapshot() {
+        reset_peak_rss();
+        baseline = peak_rss();
+    }
+
+    std::size_t peak_growth() const {
+        std::size_t const peak = peak_rss();
+        return peak > baseline ? peak - baseline : 0;
+    }
+};
+
+enum class key_kind {
+    words,
+    urls,
+    random_bytes,
+    file
+};
+
+inline char const* key_kind_name(key_kind kind) {
+    switch (kind) {
+    case key_kind::words: return "words";
+    case key_kind::urls: return "urls";
+    case key_kind::random_bytes: return "random_bytes";
+    case key_kind::file: return "file";
+    }
+    return "";
+}
+
+// Path of a file with one key per line, taken from PLIB_BENCH_KEY_FILE. Returns nullptr if not set.
+inline char const* key_file_path() {
+    return std::getenv("PLIB_BENCH_KEY_FILE");
+}
+
+namespace detail {
+
+inline std::string make_word(std::mt19937_64& rng) {
+    // Letter frequencies loosely follow english so keys share prefixes like real dictionary words.
+    static constexpr char letters[] = "eeeeeeeeeeeetttttttttaaaaaaaaooooooooiiiiiiinnnnnnnsssssshhhhhhrrrrrrddddllllcccuuummwwffggyyppbbvkjxqz";
+    std::uniform_int_distribution<std::size_t> length(3, 12);
+    std::uniform_int_distribution<std::size_t> letter(0, sizeof(letters) - 2);
+    std::string word(length(rng), ' ');
+    for (char& c : word) c = letters[letter(rng)];
+    return word;
+}
+
+inline std::string make_url(std::mt19937_64& rng) {
+    static char const* const hosts[] = { "https://example.com/", "https://api.example.com/v1/", "http://cdn.example.org/static/",
+        "https://docs.example.net/reference/", "https://www.example.io/users/" };
+    std::uniform_int_distribution<std::size_t> host(0, std::size(hosts) - 1);
+    std::uniform_int_distribution<std::size_t> segments(1, 4);
+    std::string url = hosts[host(rng)];
+    std::size_t const n = segments(rng);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i != 0) url += '/';
+        url += make_word(rng);
+    }
+    return url;
+}
+
+inline std::string make_random_bytes(std::mt19937_64& rng) {
+    std::uniform_int_distribution<std::size_t> length(4, 24);
+    // Skip 0 so keys stay valid C strings when printed, and the newline which missing_keys relies on.
+    std::uniform_int_distribution<int> byte(1, 255);
+    std::string key(length(rng), ' ');
+    for (char& c : key) {
+        do c = static_cast<char>(byte(rng));
+        while (c == '\n');
+    }
+    return key;
+}
+
+inline std::vector<std::string> load_key_file(std::size_t count) {
+    std::vector<std::string> keys;
+    char const* path = key_file_path();
+    if (!path) return keys;
+
+    std::ifstream file(path);
+    std::string line;
+    while (keys.size() < count && std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) keys.push_back(std::move(line));
+    }
+    return keys;
+}
+
+} // namespace detail
+
+// Returns count keys of the given kind. Key sets are generated once and cached, the same (kind, count, seed) always yields the same keys.
+// Keys are not deduplicated, so containers may end up with slightly fewer entries than count.
+inline std::vector<std::string> const& keys(key_kind kind, std::size_t count, std::uint64_t seed = 0x706c6962) {
+    static std::map<std::pair<std::pair<key_kind, std::size_t>, std::uint64_t>, std::vector<std::string>> cache;
+    auto& result = cache[{ { kind, count }, seed }];
+    if (!result.empty()) return result;
+
+    if (kind == key_kind::file) {
+        result = detail::load_key_file(count);
+        return result;
+    }
+
+    std::mt19937_64 rng(seed);
+    result.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        switch (kind) {
+        case key_kind::words: result.push_back(detail::make_word(rng)); break;
+        case key_kind::urls: result.push_back(detail::make_url(rng)); break;
+        case key_kind::random_bytes: result.push_back(detail::make_random_bytes(rng)); break;
+        case key_kind::file: break;
+        }
+    }
+    return result;
+}
+
+// Keys of the same kind that are (almost certainly) not in keys(kind, count).
+inline std::vector<std::string> const& missing_keys(key_kind kind, std::size_t count) {
+    static std::map<std::pair<key_kind, std::size_t>, std::vector<std::string>> cache;
+    auto& result = cache[{ kind, count }];
+    if (!result.empty()) return result;
+
+    // No generator produces a newline and lines read from a key file never contain one, so appending it guarantees a miss.
+    std::vector<std::string> const& source = keys(kind, count);
+    result.reserve(source.size());
+    for (std::string const& key : source) result.push_back(key + '\n');
+    return result;
+}
+
+} // namespace plib::bench
+
+// Allocation tracking. Each block carries a header with its size so live bytes can be tracked on delete.
+// The aligned overloads matter too, std::pmr::new_delete_resource allocates through them.
+
+namespace plib::bench::detail {
+
+inline constexpr std::size_t alloc_header = alignof(std::max_align_t);
+
+inline void* tracked_alloc(std::size_t size, std::size_t alignment = alloc_header) {
+    // The header is padded to the alignment so the returned pointer keeps it.
+    std::size_t const header = std::max(alignment, alloc_header);
+    void* block = alignment <= alloc_header
+        ? std::malloc(size + header)
+        : std::aligned_alloc(alignment, (size + header + alignment - 1) / alignment * alignment);
+    if (!block) throw std::bad_alloc();
+    *static_cast<std::size_t*>(block) = size;
+    allocations().count.fetch_add(1, std::memory_order_relaxed);
+    allocations().live_bytes.fetch_add(size, std::memory_order_relaxed);
+    return static_cast<unsigned char*>(block) + header;
+}
+
+inline void tracked_free(void* ptr, std::size_t alignment = alloc_header) noexcept {
+    if (!ptr) return;
+    void* block = static_cast<unsigned char*>(ptr) - std::max(alignment, alloc_header);
+    allocations().live_bytes.fetch_sub(*static_cast<std::size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+} // namespace plib::bench::detail
+
+void* operator new(std::size_t size) { return plib::bench::detail::tracked_alloc(size); }
+void* operator new[](std::size_t size) { return plib::bench::detail::tracked_alloc(size); }
+void operator delete(void* ptr) noexcept { plib::bench::detail::tracked_free(ptr); }
+void operator delete[](void* ptr) noexcept { plib::bench::detail::tracked_free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { plib::bench::detail::tracked_free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { plib::bench::detail::tracked_free(ptr); }
+
+void* operator new(std::size_t size, std::align_val_t al) { return plib::bench::detail::tracked_alloc(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return plib::bench::detail::tracked_alloc(size, static_cast<std::size_t>(al)); }
+void operator delete(void* ptr, std::align_val_t al) noexcept { plib::bench::detail::tracked_free(ptr, static_cast<std::size_t>(al)); }
+void operator delete[](void* ptr, std::align_val_t al) noexcept { plib::bench::detail::tracked_free(ptr, static_cast<std::size_t>(al)); }
+void operator delete(void* ptr, std::size_t, std::align_val_t al) noexcept { plib::bench::detail::tracked_free(ptr, static_cast<std::size_t>(al)); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t al) noexcept { plib::bench::detail::tracked_free(ptr, static_cast<std::size_t>(al)); }
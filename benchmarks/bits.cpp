@@ -0,0 +1,209 @@
+// Throughput of the bit manipulation kernels in plib/bits.hpp. Scalar kernels are run over an array of random words,
+// pdep/pext are compared against their portable fallbacks and the bulk kernels against per-element loops.
+
+#include <plib/bits.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace {
+
+std::vector<std::uint64_t> random_words(std::size_t count) {
+    std::mt19937_64 rng(42);
+    std::vector<std::uint64_t> words(count);
+    for (std::uint64_t& word : words) word = rng();
+    return words;
+}
+
+// Masks with a varying density of set bits, so the portable pdep/pext loops see realistic work.
+constexpr std::uint64_t sparse_mask = 0x8040201008040201ull;
+constexpr std::uint64_t morton_mask = 0x5555555555555555ull;
+
+template<typename F>
+void run_scalar(benchmark::State& state, F kernel) {
+    std::vector<std::uint64_t> const words = random_words(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::uint64_t acc = 0;
+        for (std::uint64_t word : words) acc += static_cast<std::uint64_t>(kernel(word));
+        benchmark::DoNotOptimize(acc);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bench_popcount(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::popcount(w); });
+}
+
+void bench_countl_zero(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::countl_zero(w); });
+}
+
+void bench_countr_zero(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::countr_zero(w); });
+}
+
+void bench_log2_floor(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::log2_floor(w); });
+}
+
+void bench_log2_ceil(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::log2_ceil(w); });
+}
+
+void bench_bit_reverse(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::bit_reverse(w); });
+}
+
+void bench_pdep(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::pdep(w, morton_mask); });
+}
+
+void bench_pdep_portable(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::detail::pdep_portable(w, morton_mask); });
+}
+
+void bench_pext(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::pext(w, morton_mask); });
+}
+
+void bench_pext_portable(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::detail::pext_portable(w, morton_mask); });
+}
+
+void bench_pext_sparse(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::pext(w, sparse_mask); });
+}
+
+void bench_pext_sparse_portable(benchmark::State& state) {
+    run_scalar(state, [](std::uint64_t w) { return plib::detail::pext_portable(w, sparse_mask); });
+}
+
+void bench_popcount_bulk(benchmark::State& state) {
+    std::vector<std::uint64_t> const words = random_words(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(plib::popcount(std::span<std::uint64_t const>(words)));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 8);
+}
+
+void bench_popcount_bulk_portable(benchmark::State& state) {
+    std::vector<std::uint64_t> const words = random_words(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(plib::detail::popcount_portable(words));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 8);
+}
+
+// dst op= src over two arrays. Applying the same operation repeatedly does the same amount of work every iteration.
+template<typename F>
+void run_binary(benchmark::State& state, F kernel) {
+    std::size_t const count = static_cast<std::size_t>(state.range(0));
+    std::vector<std::uint64_t> dst = random_words(count);
+    std::vector<std::uint64_t> src = random_words(count);
+    std::reverse(src.begin(), src.end());
+    for (auto _ : state) {
+        kernel(std::span<std::uint64_t>(dst), std::span<std::uint64_t const>(src));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * 8);
+}
+
+void bench_and_bulk(benchmark::State& state) {
+    run_binary(state, [](auto dst, auto src) { plib::bit_and(dst, src); });
+}
+
+void bench_and_bulk_portable(benchmark::State& state) {
+    run_binary(state, [](auto dst, auto src) { plib::detail::and_portable(dst, src); });
+}
+
+void bench_or_bulk(benchmark::State& state) {
+    run_binary(state, [](auto dst, auto src) { plib::bit_or(dst, src); });
+}
+
+void bench_or_bulk_portable(benchmark::State& state) {
+    run_binary(state, [](auto dst, auto src) { plib::detail::or_portable(dst, src); });
+}
+
+void bench_xor_bulk(benchmark::State& state) {
+    run_binary(state, [](auto dst, auto src) { plib::bit_xor(dst, src); });
+}
+
+void bench_xor_bulk_portable(benchmark::State& state) {
+    run_binary(state, [](auto dst, auto src) { plib::detail::xor_portable(dst, src); });
+}
+
+void bench_and_not_bulk(benchmark::State& state) {
+    run_binary(state, [](auto dst, auto src) { plib::bit_and_not(dst, src); });
+}
+
+void bench_and_not_bulk_portable(benchmark::State& state) {
+    run_binary(state, [](auto dst, auto src) { plib::detail::and_not_portable(dst, src); });
+}
+
+void bench_pdep_bulk(benchmark::State& state) {
+    std::vector<std::uint64_t> const words = random_words(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::uint64_t> out(words.size());
+    for (auto _ : state) {
+        plib::pdep(words, morton_mask, out);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bench_pext_bulk(benchmark::State& state) {
+    std::vector<std::uint64_t> const words = random_words(static_cast<std::size_t>(state.range(0)));
+    std::vector<std::uint64_t> out(words.size());
+    for (auto _ : state) {
+        plib::pext(words, morton_mask, out);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bench_bit_reverse_bulk(benchmark::State& state) {
+    std::vector<std::uint64_t> words = random_words(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        plib::bit_reverse(std::span<std::uint64_t>(words));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+// 4096 words stay in L1, 1M words go to memory.
+#define PLIB_BITS_BENCHMARK(name) BENCHMARK(name)->Arg(4096)->Arg(1 << 20)
+
+PLIB_BITS_BENCHMARK(bench_popcount);
+PLIB_BITS_BENCHMARK(bench_countl_zero);
+PLIB_BITS_BENCHMARK(bench_countr_zero);
+PLIB_BITS_BENCHMARK(bench_log2_floor);
+PLIB_BITS_BENCHMARK(bench_log2_ceil);
+PLIB_BITS_BENCHMARK(bench_bit_reverse);
+PLIB_BITS_BENCHMARK(bench_pdep);
+PLIB_BITS_BENCHMARK(bench_pdep_portable);
+PLIB_BITS_BENCHMARK(bench_pext);
+PLIB_BITS_BENCHMARK(bench_pext_portable);
+PLIB_BITS_BENCHMARK(bench_pext_sparse);
+PLIB_BITS_BENCHMARK(bench_pext_sparse_portable);
+PLIB_BITS_BENCHMARK(bench_popcount_bulk);
+PLIB_BITS_BENCHMARK(bench_popcount_bulk_portable);
+PLIB_BITS_BENCHMARK(bench_and_bulk);
+PLIB_BITS_BENCHMARK(bench_and_bulk_portable);
+PLIB_BITS_BENCHMARK(bench_or_bulk);
+PLIB_BITS_BENCHMARK(bench_or_bulk_portable);
+PLIB_BITS_BENCHMARK(bench_xor_bulk);
+PLIB_BITS_BENCHMARK(bench_xor_bulk_portable);
+PLIB_BITS_BENCHMARK(bench_and_not_bulk);
+PLIB_BITS_BENCHMARK(bench_and_not_bulk_portable);
+PLIB_BITS_BENCHMARK(bench_pdep_bulk);
+PLIB_BITS_BENCHMARK(bench_pext_bulk);
+PLIB_BITS_BENCHMARK(bench_bit_reverse_bulk);
+
+BENCHMARK_MAIN();
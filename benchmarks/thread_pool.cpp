@@ -0,0 +1,105 @@
+// Task spawn and steal latency of plib::thread_pool, and parallel_for scaling over the amount of workers.
+
+#include "bench_common.hpp"
+
+#include <plib/thread_pool.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace plib::bench;
+
+std::size_t hardware_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Round trip of a single empty task submitted from outside the pool.
+void bench_spawn_external(benchmark::State& state) {
+    plib::thread_pool pool(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto handle = pool.submit([] { return 1; });
+        benchmark::DoNotOptimize(handle.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// A worker spawns a batch of empty tasks onto its own deque and waits for them.
+// With a single worker this is pure push/pop cost, with more workers part of the batch gets stolen.
+void bench_spawn_local(benchmark::State& state) {
+    constexpr std::size_t batch = 1024;
+    plib::thread_pool pool(static_cast<std::size_t>(state.range(0)));
+    std::size_t allocs = 0;
+    for (auto _ : state) {
+        alloc_snapshot const before;
+        pool.submit([&pool] {
+            std::vector<plib::task_handle<void>> handles;
+            handles.reserve(batch);
+            for (std::size_t i = 0; i < batch; ++i) handles.push_back(pool.submit([] {}));
+            for (auto& handle : handles) handle.wait();
+        }).get();
+        allocs = before.count_since();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * batch));
+    state.counters["allocs_per_task"] = static_cast<double>(allocs) / batch;
+}
+
+// All work starts on one worker's deque, every other worker has to steal it.
+// Each task spins for a short, fixed time so thieves have a chance to take part.
+void bench_steal(benchmark::State& state) {
+    constexpr std::size_t batch = 4096;
+    plib::thread_pool pool(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::atomic<std::size_t> done = 0;
+        pool.submit([&] {
+            for (std::size_t i = 0; i < batch; ++i) {
+                pool.submit([&done] {
+                    volatile double x = 1.0;
+                    for (int j = 0; j < 200; ++j) x = x * 1.0000001;
+                    done.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        }).get();
+        while (done.load(std::memory_order_relaxed) != batch) pool.run_one();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * batch));
+}
+
+void bench_parallel_for(benchmark::State& state) {
+    std::size_t const threads = static_cast<std::size_t>(state.range(0));
+    std::size_t const count = static_cast<std::size_t>(state.range(1));
+    plib::thread_pool pool(threads);
+    std::vector<double> data(count, 2.0);
+    for (auto _ : state) {
+        pool.parallel_for(0, count, [&data](std::size_t i) { data[i] = std::sqrt(data[i] + 1.0); });
+        benchmark::DoNotOptimize(data.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * count));
+    state.counters["threads"] = static_cast<double>(threads);
+}
+
+void thread_counts(benchmark::internal::Benchmark* bench) {
+    for (std::size_t threads = 1; threads <= hardware_threads(); threads *= 2) bench->Arg(static_cast<std::int64_t>(threads));
+}
+
+void parallel_for_args(benchmark::internal::Benchmark* bench) {
+    for (std::int64_t count : { 1 << 16, 1 << 22 }) {
+        for (std::size_t threads = 1; threads <= hardware_threads(); threads *= 2) {
+            bench->Args({ static_cast<std::int64_t>(threads), count });
+        }
+    }
+}
+
+} // namespace
+
+BENCHMARK(bench_spawn_external)->Apply(thread_counts)->UseRealTime();
+BENCHMARK(bench_spawn_local)->Apply(thread_counts)->UseRealTime();
+BENCHMARK(bench_steal)->Apply(thread_counts)->UseRealTime();
+BENCHMARK(bench_parallel_for)->Apply(parallel_for_args)->UseRealTime();
+
+BENCHMARK_MAIN();
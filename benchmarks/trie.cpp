@@ -0,0 +1,260 @@
+// Compares plib::trie against plib::flat_hash_map, std::unordered_map and std::map.
+//
+// Every benchmark is registered for each key set (words, urls, random_bytes and, if PLIB_BENCH_KEY_FILE points to
+// a file with one key per line, the keys from that file) at sizes from 1K up to PLIB_BENCH_MAX_KEYS keys (default 10M).
+// Use --benchmark_filter to select a subset, the larger sizes take a long time and a lot of memory.
+
+#include "bench_common.hpp"
+
+#include <plib/flat_hash_map.hpp>
+#include <plib/trie.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using namespace plib::bench;
+
+using value_type = std::uint32_t;
+
+struct trie_adapter {
+    static constexpr char const* name = "trie";
+
+    plib::trie<std::string, value_type> container;
+
+    void insert(std::string const& key, value_type value) {
+        container.insert(key, std::move(value));
+    }
+
+    bool contains(std::string const& key) const {
+        return container.get(key).has_value();
+    }
+
+    std::size_t count_with_prefix(std::string const& prefix) const {
+        return container.collect_with_prefix(prefix).size();
+    }
+};
+
+struct unordered_map_adapter {
+    static constexpr char const* name = "unordered_map";
+
+    std::unordered_map<std::string, value_type> container;
+
+    void insert(std::string const& key, value_type value) {
+        container.emplace(key, value);
+    }
+
+    bool contains(std::string const& key) const {
+        return container.find(key) != container.end();
+    }
+
+    // No ordering, so the only option is a full scan.
+    std::size_t count_with_prefix(std::string const& prefix) const {
+        std::size_t count = 0;
+        for (auto const& [key, value] : container) {
+            if (key.starts_with(prefix)) ++count;
+        }
+        return count;
+    }
+};
+
+struct flat_hash_map_adapter {
+    static constexpr char const* name = "flat_hash_map";
+
+    plib::flat_hash_map<std::string, value_type> container;
+
+    void insert(std::string const& key, value_type value) {
+        container.try_emplace(key, value);
+    }
+
+    bool contains(std::string const& key) const {
+        return container.contains(key);
+    }
+
+    // No ordering, so the only option is a full scan.
+    std::size_t count_with_prefix(std::string const& prefix) const {
+        std::size_t count = 0;
+        for (auto const& [key, value] : container) {
+            if (key.starts_with(prefix)) ++count;
+        }
+        return count;
+    }
+};
+
+struct map_adapter {
+    static constexpr char const* name = "map";
+
+    std::map<std::string, value_type> container;
+
+    void insert(std::string const& key, value_type value) {
+        container.emplace(key, value);
+    }
+
+    bool contains(std::string const& key) const {
+        return container.find(key) != container.end();
+    }
+
+    std::size_t count_with_prefix(std::string const& prefix) const {
+        std::size_t count = 0;
+        for (auto it = container.lower_bound(prefix); it != container.end() && it->first.starts_with(prefix); ++it) {
+            ++count;
+        }
+        return count;
+    }
+};
+
+template<typename Adapter>
+std::unique_ptr<Adapter> build(std::vector<std::string> const& key_set) {
+    auto adapter = std::make_unique<Adapter>();
+    value_type value = 0;
+    for (std::string const& key : key_set) {
+        adapter->insert(key, value++);
+    }
+    return adapter;
+}
+
+// Building the large containers dominates the run time, so the most recently built one is kept around
+// and shared between the lookup benchmarks and repeated runs of the same benchmark.
+template<typename Adapter>
+Adapter const& cached_build(key_kind kind, std::size_t size) {
+    static std::unique_ptr<Adapter> adapter;
+    static key_kind cached_kind{};
+    static std::size_t cached_size = 0;
+    if (!adapter || cached_kind != kind || cached_size != size) {
+        adapter.reset();
+        adapter = build<Adapter>(keys(kind, size));
+        cached_kind = kind;
+        cached_size = size;
+    }
+    return *adapter;
+}
+
+template<typename Adapter>
+void bench_insert(benchmark::State& state, key_kind kind, std::size_t size) {
+    std::vector<std::string> const& key_set = keys(kind, size);
+    std::size_t allocs = 0;
+    std::ptrdiff_t bytes = 0;
+    rss_snapshot const rss;
+    for (auto _ : state) {
+        alloc_snapshot const before;
+        auto adapter = build<Adapter>(key_set);
+        allocs = before.count_since();
+        bytes = before.bytes_since();
+        benchmark::DoNotOptimize(adapter.get());
+
+        state.PauseTiming();
+        adapter.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * key_set.size()));
+    state.counters["allocs_per_key"] = static_cast<double>(allocs) / static_cast<double>(key_set.size());
+    state.counters["bytes_per_key"] = static_cast<double>(bytes) / static_cast<double>(key_set.size());
+    state.counters["peak_rss_growth_mb"] = static_cast<double>(rss.peak_growth()) / (1024.0 * 1024.0);
+}
+
+template<typename Adapter>
+void bench_get(benchmark::State& state, key_kind kind, std::size_t size, bool hit) {
+    Adapter const& adapter = cached_build<Adapter>(kind, size);
+    std::vector<std::string> const& queries = hit ? keys(kind, size) : missing_keys(kind, size);
+
+    std::size_t allocs = 0;
+    for (auto _ : state) {
+        alloc_snapshot const before;
+        std::size_t found = 0;
+        for (std::string const& key : queries) {
+            found += adapter.contains(key);
+        }
+        allocs = before.count_since();
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * queries.size()));
+    state.counters["allocs_per_op"] = static_cast<double>(allocs) / static_cast<double>(queries.size());
+}
+
+template<typename Adapter>
+void bench_prefix(benchmark::State& state, key_kind kind, std::size_t size) {
+    constexpr std::size_t prefix_count = 64;
+    constexpr std::size_t prefix_length = 3;
+
+    Adapter const& adapter = cached_build<Adapter>(kind, size);
+    std::vector<std::string> const& key_set = keys(kind, size);
+
+    // Prefixes of stored keys, spread evenly over the key set.
+    std::vector<std::string> prefixes;
+    for (std::size_t i = 0; i < prefix_count; ++i) {
+        std::string const& key = key_set[i * key_set.size() / prefix_count];
+        prefixes.push_back(key.substr(0, std::min(prefix_length, key.size())));
+    }
+
+    std::size_t allocs = 0;
+    std::size_t results = 0;
+    for (auto _ : state) {
+        alloc_snapshot const before;
+        results = 0;
+        for (std::string const& prefix : prefixes) {
+            results += adapter.count_with_prefix(prefix);
+        }
+        allocs = before.count_since();
+        benchmark::DoNotOptimize(results);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * prefixes.size()));
+    state.counters["results_per_op"] = static_cast<double>(results) / static_cast<double>(prefixes.size());
+    state.counters["allocs_per_op"] = static_cast<double>(allocs) / static_cast<double>(prefixes.size());
+}
+
+std::vector<std::size_t> sizes(key_kind kind) {
+    std::size_t max_size = 10'000'000;
+    if (char const* max = std::getenv("PLIB_BENCH_MAX_KEYS")) max_size = std::strtoull(max, nullptr, 10);
+
+    std::vector<std::size_t> result;
+    for (std::size_t size = 1'000; size <= max_size; size *= 10) {
+        result.push_back(size);
+    }
+
+    if (kind == key_kind::file) {
+        // Only keep sizes the file can fill, plus the full file if it is smaller than the largest size.
+        std::size_t const available = keys(key_kind::file, max_size).size();
+        std::erase_if(result, [available](std::size_t size) { return size > available; });
+        if (available != 0 && (result.empty() || result.back() != available)) result.push_back(available);
+    }
+    return result;
+}
+
+template<typename Adapter>
+void register_benchmarks(key_kind kind, std::size_t size) {
+    std::string const suffix = std::string("/") + Adapter::name + "/" + key_kind_name(kind) + "/" + std::to_string(size);
+    auto const unit = size >= 1'000'000 ? benchmark::kMillisecond : benchmark::kMicrosecond;
+
+    benchmark::RegisterBenchmark(("insert" + suffix).c_str(), bench_insert<Adapter>, kind, size)->Unit(unit);
+    benchmark::RegisterBenchmark(("get_hit" + suffix).c_str(), bench_get<Adapter>, kind, size, true)->Unit(unit);
+    benchmark::RegisterBenchmark(("get_miss" + suffix).c_str(), bench_get<Adapter>, kind, size, false)->Unit(unit);
+    benchmark::RegisterBenchmark(("prefix" + suffix).c_str(), bench_prefix<Adapter>, kind, size)->Unit(unit);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<key_kind> kinds = { key_kind::words, key_kind::urls, key_kind::random_bytes };
+    if (key_file_path()) kinds.push_back(key_kind::file);
+
+    for (key_kind kind : kinds) {
+        for (std::size_t size : sizes(kind)) {
+            register_benchmarks<trie_adapter>(kind, size);
+            register_benchmarks<flat_hash_map_adapter>(kind, size);
+            register_benchmarks<unordered_map_adapter>(kind, size);
+            register_benchmarks<map_adapter>(kind, size);
+        }
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <plib/bit_flag.hpp>
+
+#include <atomic>
+
+namespace plib {
+
+    // Bit flag that can be modified by multiple threads at once. All modifications are single lock-free atomic operations.
+    // Compound assignment operators return the new value like std::atomic does, the fetch_ functions return the old value.
+    template<typename E>
+    class atomic_bit_flag {
+    public:
+        using enum_type = E;
+        using underlying_type = underlying_type_t<E>;
+        using flag_type = bit_flag<E>;
+
+        static_assert(std::atomic<underlying_type>::is_always_lock_free, "atomic_bit_flag requires a lock-free underlying type");
+
+        atomic_bit_flag() = default;
+        atomic_bit_flag(flag_type value) : _value(value.value()) {}
+        atomic_bit_flag(enum_type value) : _value(static_cast<underlying_type>(value)) {}
+        atomic_bit_flag(atomic_bit_flag const&) = delete;
+        atomic_bit_flag& operator=(atomic_bit_flag const&) = delete;
+        atomic_bit_flag& operator=(flag_type value) { store(value); return *this; }
+        atomic_bit_flag& operator=(enum_type value) { store(value); return *this; }
+
+        flag_type load(std::memory_order order = std::memory_order_seq_cst) const {
+            return flag_type(_value.load(order));
+        }
+
+        void store(flag_type value, std::memory_order order = std::memory_order_seq_cst) {
+            _value.store(value.value(), order);
+        }
+
+        flag_type exchange(flag_type value, std::memory_order order = std::memory_order_seq_cst) {
+            return flag_type(_value.exchange(value.value(), order));
+        }
+
+        operator flag_type() const {
+            return load();
+        }
+
+        // Read-modify-write operations, these return the value before the operation.
+
+        flag_type fetch_or(flag_type value, std::memory_order order = std::memory_order_seq_cst) {
+            return flag_type(_value.fetch_or(value.value(), order));
+        }
+
+        flag_type fetch_and(flag_type value, std::memory_order order = std::memory_order_seq_cst) {
+            return flag_type(_value.fetch_and(value.value(), order));
+        }
+
+        flag_type fetch_xor(flag_type value, std::memory_order order = std::memory_order_seq_cst) {
+            return flag_type(_value.fetch_xor(value.value(), order));
+        }
+
+        // Check if all bits of a flag are set.
+        bool test(enum_type flag, std::memory_order order = std::memory_order_seq_cst) const {
+            underlying_type const bits = static_cast<underlying_type>(flag);
+            return (_value.load(order) & bits) == bits;
+        }
+
+        // Set the bits of a flag. Returns true if they were all set already,
+        // so exactly one of several threads racing to set the flag sees false.
+        bool test_and_set(enum_type flag, std::memory_order order = std::memory_order_seq_cst) {
+            underlying_type const bits = static_cast<underlying_type>(flag);
+            return (_value.fetch_or(bits, order) & bits) == bits;
+        }
+
+        // Clear the bits of a flag. Returns true if they were all set before.
+        bool test_and_reset(enum_type flag, std::memory_order order = std::memory_order_seq_cst) {
+            underlying_type const bits = static_cast<underlying_type>(flag);
+            return (_value.fetch_and(static_cast<underlying_type>(~bits), order) & bits) == bits;
+        }
+
+        bool compare_exchange_weak(flag_type& expected, flag_type desired,
+                                   std::memory_order success = std::memory_order_seq_cst,
+                                   std::memory_order failure = std::memory_order_seq_cst) {
+            underlying_type raw = expected.value();
+            bool const result = _value.compare_exchange_weak(raw, desired.value(), success, failure);
+            expected = raw;
+            return result;
+        }
+
+        bool compare_exchange_strong(flag_type& expected, flag_type desired,
+                                     std::memory_order success = std::memory_order_seq_cst,
+                                     std::memory_order failure = std::memory_order_seq_cst) {
+            underlying_type raw = expected.value();
+            bool const result = _value.compare_exchange_strong(raw, desired.value(), success, failure);
+            expected = raw;
+            return result;
+        }
+
+        // Waiting
+
+        // Block until the value is no longer equal to old.
+        void wait(flag_type old, std::memory_order order = std::memory_order_seq_cst) const {
+            _value.wait(old.value(), order);
+        }
+
+        // Block until all bits of a flag are set. Returns the value that satisfied the wait.
+        flag_type wait_for_set(enum_type flag, std::memory_order order = std::memory_order_seq_cst) const {
+            underlying_type const bits = static_cast<underlying_type>(flag);
+            underlying_type current = _value.load(order);
+            while ((current & bits) != bits) {
+                _value.wait(current, order);
+                current = _value.load(order);
+            }
+            return flag_type(current);
+        }
+
+        // Modifying the flag does not wake up waiters, call one of these after it.
+
+        void notify_one() {
+            _value.notify_one();
+        }
+
+        void notify_all() {
+            _value.notify_all();
+        }
+
+        // Operations, these return the value after the operation.
+
+        flag_type operator&=(flag_type const rhs) {
+            return flag_type(_value.fetch_and(rhs.value()) & rhs.value());
+        }
+
+        flag_type operator|=(flag_type const rhs) {
+            return flag_type(_value.fetch_or(rhs.value()) | rhs.value());
+        }
+
+        flag_type operator^=(flag_type const rhs) {
+            return flag_type(_value.fetch_xor(rhs.value()) ^ rhs.value());
+        }
+
+        flag_type operator&=(E const rhs) {
+            return *this &= flag_type(rhs);
+        }
+
+        flag_type operator|=(E const rhs) {
+            return *this |= flag_type(rhs);
+        }
+
+        flag_type operator^=(E const rhs) {
+            return *this ^= flag_type(rhs);
+        }
+
+        // Binary operators work on a snapshot taken with load(), so an atomic_bit_flag can be used wherever a bit_flag is read.
+
+        friend flag_type operator&(atomic_bit_flag const& lhs, flag_type const rhs) {
+            return lhs.load() & rhs;
+        }
+
+        friend flag_type operator|(atomic_bit_flag const& lhs, flag_type const rhs) {
+            return lhs.load() | rhs;
+        }
+
+        friend flag_type operator^(atomic_bit_flag const& lhs, flag_type const rhs) {
+            return lhs.load() ^ rhs;
+        }
+
+        friend flag_type operator&(flag_type const lhs, atomic_bit_flag const& rhs) {
+            return lhs & rhs.load();
+        }
+
+        friend flag_type operator|(flag_type const lhs, atomic_bit_flag const& rhs) {
+            return lhs | rhs.load();
+        }
+
+        friend flag_type operator^(flag_type const lhs, atomic_bit_flag const& rhs) {
+            return lhs ^ rhs.load();
+        }
+
+        friend flag_type operator&(atomic_bit_flag const& lhs, E const rhs) {
+            return lhs.load() & rhs;
+        }
+
+        friend flag_type operator|(atomic_bit_flag const& lhs, E const rhs) {
+            return lhs.load() | rhs;
+        }
+
+        friend flag_type operator^(atomic_bit_flag const& lhs, E const rhs) {
+            return lhs.load() ^ rhs;
+        }
+
+        friend flag_type operator&(E const lhs, atomic_bit_flag const& rhs) {
+            return lhs & rhs.load();
+        }
+
+        friend flag_type operator|(E const lhs, atomic_bit_flag const& rhs) {
+            return lhs | rhs.load();
+        }
+
+        friend flag_type operator^(E const lhs, atomic_bit_flag const& rhs) {
+            return lhs ^ rhs.load();
+        }
+
+        friend flag_type operator~(atomic_bit_flag const& lhs) {
+            return ~lhs.load();
+        }
+
+        friend bool operator==(atomic_bit_flag const& lhs, flag_type const rhs) {
+            return lhs.load() == rhs;
+        }
+
+        friend bool operator!(atomic_bit_flag const& lhs) {
+            return !lhs._value.load();
+        }
+
+        explicit operator bool() const {
+            return static_cast<bool>(_value.load());
+        }
+
+    private:
+        std::atomic<underlying_type> _value = 0;
+    };
+}
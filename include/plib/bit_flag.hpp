@@ -42,7 +42,7 @@ namespace plib {
         }
 
         friend bit_flag operator^(bit_flag const lhs, bit_flag const rhs) {
-            return bit_flag(lhs._value ^ rhs.v_alue);
+            return bit_flag(lhs._value ^ rhs._value);
         }
 
         friend bit_flag operator~(bit_flag const lhs) {
@@ -1,6 +1,28 @@
 #pragma once
 
+#include <plib/macros.hpp>
+
+#include <bit>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define PLIB_BITS_X86 1
+#    include <immintrin.h>
+#    if defined(_MSC_VER) && !defined(__clang__)
+#        include <intrin.h>
+// MSVC allows intrinsics for any instruction set in any function.
+#        define PLIB_BITS_TARGET(isa)
+#    else
+// Compile a single function for an instruction set that is not enabled for the whole build, it is only called after checking cpu_features.
+#        define PLIB_BITS_TARGET(isa) __attribute__((target(isa)))
+#    endif
+#endif
 
 namespace plib {
 
@@ -19,4 +41,345 @@ inline std::size_t next_pow_two(std::size_t v) {
     return v + 1;
 }
 
-} // namespace plib
\ No newline at end of file
+/**
+ * @brief Instruction set extensions relevant to the bit kernels, detected once at startup.
+ */
+struct cpu_feature_set {
+    bool popcnt = false;
+    bool avx2 = false;
+    bool bmi2 = false;
+    // pdep/pext are microcoded on AMD CPUs before Zen 3 and are much slower than the portable loops there.
+    bool fast_pdep = false;
+};
+
+namespace detail {
+
+inline cpu_feature_set detect_cpu_features() {
+    cpu_feature_set features;
+#if defined(PLIB_BITS_X86) && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int const max_leaf = info[0];
+    bool const amd = info[1] == 0x68747541; // "Auth"enticAMD
+    __cpuid(info, 1);
+    features.popcnt = (info[2] >> 23) & 1;
+    bool const os_avx = ((info[2] >> 27) & 1) && ((info[2] >> 28) & 1) && (_xgetbv(0) & 0x6) == 0x6;
+    unsigned const family = ((info[0] >> 8) & 0xF) + ((info[0] >> 20) & 0xFF);
+    if (max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        features.avx2 = os_avx && ((info[1] >> 5) & 1);
+        features.bmi2 = (info[1] >> 8) & 1;
+    }
+    features.fast_pdep = features.bmi2 && !(amd && family < 0x19);
+#elif defined(PLIB_BITS_X86)
+    __builtin_cpu_init();
+    features.popcnt = __builtin_cpu_supports("popcnt");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.bmi2 = __builtin_cpu_supports("bmi2");
+    features.fast_pdep = features.bmi2 && !__builtin_cpu_is("amdfam10h") && !__builtin_cpu_is("amdfam15h")
+                         && !__builtin_cpu_is("amdfam17h");
+#endif
+    return features;
+}
+
+} // namespace detail
+
+/**
+ * @brief Features of the CPU the program runs on. Until it is initialized during static initialization every feature
+ *        reads as false, so code running before that safely takes the portable paths.
+ */
+inline cpu_feature_set const cpu_features = detail::detect_cpu_features();
+
+// Scalar kernels. These are constexpr, at runtime they compile to single instructions wherever the target has them.
+
+/**
+ * @brief Amount of set bits. This is the popcnt instruction when the build enables it (-mpopcnt, or a -march that has it).
+ *        A runtime check would cost more than the instruction saves, only the bulk overload dispatches on cpu_features.
+ */
+template<std::unsigned_integral T>
+constexpr int popcount(T x) noexcept {
+    return std::popcount(x);
+}
+
+template<std::unsigned_integral T>
+constexpr int countl_zero(T x) noexcept {
+    return std::countl_zero(x);
+}
+
+template<std::unsigned_integral T>
+constexpr int countr_zero(T x) noexcept {
+    return std::countr_zero(x);
+}
+
+/**
+ * @brief floor(log2(x)), the index of the highest set bit. Returns -1 for x == 0.
+ */
+template<std::unsigned_integral T>
+constexpr int log2_floor(T x) noexcept {
+    return static_cast<int>(std::bit_width(x)) - 1;
+}
+
+/**
+ * @brief ceil(log2(x)), the exponent of the smallest power of two that is not smaller than x. Returns 0 for x <= 1.
+ */
+template<std::unsigned_integral T>
+constexpr int log2_ceil(T x) noexcept {
+    return x <= 1 ? 0 : static_cast<int>(std::bit_width(static_cast<T>(x - 1)));
+}
+
+/**
+ * @brief Reverse the order of the bits in x, bit 0 becomes the highest bit.
+ */
+template<std::unsigned_integral T>
+constexpr T bit_reverse(T x) noexcept {
+    static_assert(std::numeric_limits<T>::digits <= 64, "bit_reverse supports integers of up to 64 bits");
+#if PLIB_HAS_BUILTIN(__builtin_bitreverse64)
+    if (!std::is_constant_evaluated()) {
+        return static_cast<T>(__builtin_bitreverse64(x) >> (64 - std::numeric_limits<T>::digits));
+    }
+#endif
+    std::uint64_t v = x;
+    v = ((v >> 1) & 0x5555555555555555ull) | ((v & 0x5555555555555555ull) << 1);
+    v = ((v >> 2) & 0x3333333333333333ull) | ((v & 0x3333333333333333ull) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((v & 0x0F0F0F0F0F0F0F0Full) << 4);
+    v = ((v >> 8) & 0x00FF00FF00FF00FFull) | ((v & 0x00FF00FF00FF00FFull) << 8);
+    v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+    v = (v >> 32) | (v << 32);
+    return static_cast<T>(v >> (64 - std::numeric_limits<T>::digits));
+}
+
+namespace detail {
+
+// Portable parallel bit deposit/extract, one iteration per set bit of the mask.
+
+constexpr std::uint64_t pdep_portable(std::uint64_t src, std::uint64_t mask) noexcept {
+    std::uint64_t result = 0;
+    for (std::uint64_t bit = 1; mask; bit <<= 1) {
+        if (src & bit) result |= mask & (~mask + 1);
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+constexpr std::uint64_t pext_portable(std::uint64_t src, std::uint64_t mask) noexcept {
+    std::uint64_t result = 0;
+    for (std::uint64_t bit = 1; mask; bit <<= 1) {
+        if (src & mask & (~mask + 1)) result |= bit;
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+inline std::size_t popcount_portable(std::span<std::uint64_t const> words) noexcept {
+    std::size_t total = 0;
+    for (std::uint64_t word : words) total += static_cast<std::size_t>(std::popcount(word));
+    return total;
+}
+
+inline void and_portable(std::span<std::uint64_t> dst, std::span<std::uint64_t const> src) noexcept {
+    for (std::size_t i = 0; i < dst.size(); ++i) dst[i] &= src[i];
+}
+
+inline void or_portable(std::span<std::uint64_t> dst, std::span<std::uint64_t const> src) noexcept {
+    for (std::size_t i = 0; i < dst.size(); ++i) dst[i] |= src[i];
+}
+
+inline void xor_portable(std::span<std::uint64_t> dst, std::span<std::uint64_t const> src) noexcept {
+    for (std::size_t i = 0; i < dst.size(); ++i) dst[i] ^= src[i];
+}
+
+inline void and_not_portable(std::span<std::uint64_t> dst, std::span<std::uint64_t const> src) noexcept {
+    for (std::size_t i = 0; i < dst.size(); ++i) dst[i] &= ~src[i];
+}
+
+#if defined(PLIB_BITS_X86)
+
+PLIB_BITS_TARGET("bmi2") inline std::uint64_t pdep_bmi2(std::uint64_t src, std::uint64_t mask) noexcept {
+    return _pdep_u64(src, mask);
+}
+
+PLIB_BITS_TARGET("bmi2") inline std::uint64_t pext_bmi2(std::uint64_t src, std::uint64_t mask) noexcept {
+    return _pext_u64(src, mask);
+}
+
+PLIB_BITS_TARGET("bmi2") inline void pdep_bmi2(std::uint64_t const* src, std::uint64_t mask, std::uint64_t* dst, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) dst[i] = _pdep_u64(src[i], mask);
+}
+
+PLIB_BITS_TARGET("bmi2") inline void pext_bmi2(std::uint64_t const* src, std::uint64_t mask, std::uint64_t* dst, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; ++i) dst[i] = _pext_u64(src[i], mask);
+}
+
+PLIB_BITS_TARGET("popcnt") inline std::size_t popcount_popcnt(std::uint64_t const* words, std::size_t n) noexcept {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < n; ++i) total += static_cast<std::size_t>(_mm_popcnt_u64(words[i]));
+    return total;
+}
+
+// Population count of 4 words at a time using a nibble lookup table (Mula, Kurz, Lemire: "Faster Population Counts Using AVX2 Instructions").
+PLIB_BITS_TARGET("avx2") inline std::size_t popcount_avx2(std::uint64_t const* words, std::size_t n) noexcept {
+    __m256i const lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    __m256i const low_mask = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(words + i));
+        __m256i const lo = _mm256_and_si256(v, low_mask);
+        __m256i const hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+        __m256i const counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    std::size_t total = static_cast<std::size_t>(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1)
+                                                 + _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+    for (; i < n; ++i) total += static_cast<std::size_t>(std::popcount(words[i]));
+    return total;
+}
+
+// dst[i] = dst[i] op src[i] for four words per instruction, the remainder goes through the scalar expression.
+#define PLIB_BITS_BINARY_KERNEL(name, avx_op, scalar_expr)                                                          \
+    PLIB_BITS_TARGET("avx2") inline void name(std::uint64_t* dst, std::uint64_t const* src, std::size_t n) noexcept { \
+        std::size_t i = 0;                                                                                           \
+        for (; i + 4 <= n; i += 4) {                                                                                 \
+            __m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));                         \
+            __m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));                         \
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), avx_op);                                        \
+        }                                                                                                            \
+        for (; i < n; ++i) dst[i] = scalar_expr;                                                                     \
+    }
+
+PLIB_BITS_BINARY_KERNEL(and_avx2, _mm256_and_si256(a, b), dst[i] & src[i])
+PLIB_BITS_BINARY_KERNEL(or_avx2, _mm256_or_si256(a, b), dst[i] | src[i])
+PLIB_BITS_BINARY_KERNEL(xor_avx2, _mm256_xor_si256(a, b), dst[i] ^ src[i])
+// Note that _mm256_andnot_si256 negates its first operand.
+PLIB_BITS_BINARY_KERNEL(and_not_avx2, _mm256_andnot_si256(b, a), dst[i] & ~src[i])
+
+#undef PLIB_BITS_BINARY_KERNEL
+
+#endif
+
+inline void check_bulk_sizes(std::size_t src, std::size_t dst) {
+    if (src != dst) throw std::invalid_argument("Source and destination of a bulk bit operation must have the same size");
+}
+
+} // namespace detail
+
+/**
+ * @brief Parallel bit deposit: scatter the low bits of src to the positions of the set bits in mask, lowest first.
+ *        Uses the BMI2 instruction when the CPU has a fast implementation of it.
+ */
+constexpr std::uint64_t pdep(std::uint64_t src, std::uint64_t mask) noexcept {
+    if (std::is_constant_evaluated()) return detail::pdep_portable(src, mask);
+#if defined(__BMI2__)
+    return _pdep_u64(src, mask);
+#else
+#    if defined(PLIB_BITS_X86)
+    if (cpu_features.fast_pdep) return detail::pdep_bmi2(src, mask);
+#    endif
+    return detail::pdep_portable(src, mask);
+#endif
+}
+
+/**
+ * @brief Parallel bit extract: gather the bits of src at the positions of the set bits in mask into the low bits of the result.
+ *        Uses the BMI2 instruction when the CPU has a fast implementation of it.
+ */
+constexpr std::uint64_t pext(std::uint64_t src, std::uint64_t mask) noexcept {
+    if (std::is_constant_evaluated()) return detail::pext_portable(src, mask);
+#if defined(__BMI2__)
+    return _pext_u64(src, mask);
+#else
+#    if defined(PLIB_BITS_X86)
+    if (cpu_features.fast_pdep) return detail::pext_bmi2(src, mask);
+#    endif
+    return detail::pext_portable(src, mask);
+#endif
+}
+
+// Bulk kernels. The CPU features are checked once per call instead of once per element.
+
+/**
+ * @brief Total amount of set bits in an array of words.
+ */
+inline std::size_t popcount(std::span<std::uint64_t const> words) noexcept {
+#if defined(PLIB_BITS_X86)
+    if (cpu_features.avx2) return detail::popcount_avx2(words.data(), words.size());
+    if (cpu_features.popcnt) return detail::popcount_popcnt(words.data(), words.size());
+#endif
+    return detail::popcount_portable(words);
+}
+
+/**
+ * @brief dst[i] = pdep(src[i], mask) for every element. Throws std::invalid_argument if the sizes differ.
+ */
+inline void pdep(std::span<std::uint64_t const> src, std::uint64_t mask, std::span<std::uint64_t> dst) {
+    detail::check_bulk_sizes(src.size(), dst.size());
+#if defined(PLIB_BITS_X86)
+    if (cpu_features.fast_pdep) return detail::pdep_bmi2(src.data(), mask, dst.data(), src.size());
+#endif
+    for (std::size_t i = 0; i < src.size(); ++i) dst[i] = detail::pdep_portable(src[i], mask);
+}
+
+/**
+ * @brief dst[i] = pext(src[i], mask) for every element. Throws std::invalid_argument if the sizes differ.
+ */
+inline void pext(std::span<std::uint64_t const> src, std::uint64_t mask, std::span<std::uint64_t> dst) {
+    detail::check_bulk_sizes(src.size(), dst.size());
+#if defined(PLIB_BITS_X86)
+    if (cpu_features.fast_pdep) return detail::pext_bmi2(src.data(), mask, dst.data(), src.size());
+#endif
+    for (std::size_t i = 0; i < src.size(); ++i) dst[i] = detail::pext_portable(src[i], mask);
+}
+
+/**
+ * @brief dst[i] &= src[i] for every element. Throws std::invalid_argument if the sizes differ.
+ */
+inline void bit_and(std::span<std::uint64_t> dst, std::span<std::uint64_t const> src) {
+    detail::check_bulk_sizes(src.size(), dst.size());
+#if defined(PLIB_BITS_X86)
+    if (cpu_features.avx2) return detail::and_avx2(dst.data(), src.data(), dst.size());
+#endif
+    detail::and_portable(dst, src);
+}
+
+/**
+ * @brief dst[i] |= src[i] for every element. Throws std::invalid_argument if the sizes differ.
+ */
+inline void bit_or(std::span<std::uint64_t> dst, std::span<std::uint64_t const> src) {
+    detail::check_bulk_sizes(src.size(), dst.size());
+#if defined(PLIB_BITS_X86)
+    if (cpu_features.avx2) return detail::or_avx2(dst.data(), src.data(), dst.size());
+#endif
+    detail::or_portable(dst, src);
+}
+
+/**
+ * @brief dst[i] ^= src[i] for every element. Throws std::invalid_argument if the sizes differ.
+ */
+inline void bit_xor(std::span<std::uint64_t> dst, std::span<std::uint64_t const> src) {
+    detail::check_bulk_sizes(src.size(), dst.size());
+#if defined(PLIB_BITS_X86)
+    if (cpu_features.avx2) return detail::xor_avx2(dst.data(), src.data(), dst.size());
+#endif
+    detail::xor_portable(dst, src);
+}
+
+/**
+ * @brief dst[i] &= ~src[i] for every element. Throws std::invalid_argument if the sizes differ.
+ */
+inline void bit_and_not(std::span<std::uint64_t> dst, std::span<std::uint64_t const> src) {
+    detail::check_bulk_sizes(src.size(), dst.size());
+#if defined(PLIB_BITS_X86)
+    if (cpu_features.avx2) return detail::and_not_avx2(dst.data(), src.data(), dst.size());
+#endif
+    detail::and_not_portable(dst, src);
+}
+
+/**
+ * @brief Reverse the bits of every word in place.
+ */
+inline void bit_reverse(std::span<std::uint64_t> words) noexcept {
+    for (std::uint64_t& word : words) word = bit_reverse(word);
+}
+
+} // namespace plib
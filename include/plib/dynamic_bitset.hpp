@@ -0,0 +1,393 @@
+#pragma once
+
+#include <plib/bits.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace plib {
+
+namespace detail::bitset_kernels {
+
+// Position of the k-th (0-based) set bit in a word. k must be smaller than popcount(word).
+inline unsigned select_in_word(std::uint64_t word, unsigned k) {
+#if defined(__BMI2__)
+    return static_cast<unsigned>(std::countr_zero(plib::pdep(std::uint64_t(1) << k, word)));
+#else
+    for (unsigned i = 0; i < k; ++i) word &= word - 1;
+    return static_cast<unsigned>(std::countr_zero(word));
+#endif
+}
+
+} // namespace detail::bitset_kernels
+
+/**
+ * @brief Bitset with a size chosen at runtime, stored as 64-bit words. Whole-set operations go through the bulk kernels of plib/bits.hpp,
+ *        which use AVX2 when the CPU has it.
+ *        Bits past size() in the last word are always zero.
+ */
+class dynamic_bitset {
+public:
+    using word_type = std::uint64_t;
+    static constexpr std::size_t bits_per_word = 64;
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * @brief Iterates over the indices of set bits in increasing order, skipping zero words.
+     */
+    class set_bit_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::size_t const*;
+        using reference = std::size_t;
+
+        set_bit_iterator() = default;
+
+        std::size_t operator*() const {
+            return index;
+        }
+
+        set_bit_iterator& operator++() {
+            index = set->find_next(index);
+            return *this;
+        }
+
+        set_bit_iterator operator++(int) {
+            set_bit_iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend bool operator==(set_bit_iterator const& lhs, set_bit_iterator const& rhs) {
+            return lhs.index == rhs.index;
+        }
+
+    private:
+        friend class dynamic_bitset;
+
+        set_bit_iterator(dynamic_bitset const* set, std::size_t index) : set(set), index(index) {}
+
+        dynamic_bitset const* set = nullptr;
+        std::size_t index = npos;
+    };
+
+    struct set_bit_range {
+        set_bit_iterator first;
+
+        set_bit_iterator begin() const { return first; }
+        set_bit_iterator end() const { return {}; }
+    };
+
+    dynamic_bitset() = default;
+
+    /**
+     * @brief Create a bitset with size bits, all set to value.
+     */
+    explicit dynamic_bitset(std::size_t size, bool value = false) {
+        resize(size, value);
+    }
+
+    std::size_t size() const {
+        return bit_count;
+    }
+
+    bool empty() const {
+        return bit_count == 0;
+    }
+
+    /**
+     * @brief Resize the bitset. New bits are set to value.
+     */
+    void resize(std::size_t size, bool value = false) {
+        std::size_t const old_size = bit_count;
+        words.resize(word_count_for(size), value ? ~word_type(0) : word_type(0));
+        if (value && size > old_size && old_size % bits_per_word != 0) {
+            // Fill the unused bits of what used to be the last word.
+            words[old_size / bits_per_word] |= ~word_type(0) << (old_size % bits_per_word);
+        }
+        bit_count = size;
+        clear_unused_bits();
+    }
+
+    bool test(std::size_t i) const {
+        return (words[i / bits_per_word] >> (i % bits_per_word)) & 1;
+    }
+
+    bool operator[](std::size_t i) const {
+        return test(i);
+    }
+
+    dynamic_bitset& set(std::size_t i) {
+        words[i / bits_per_word] |= word_type(1) << (i % bits_per_word);
+        return *this;
+    }
+
+    dynamic_bitset& set(std::size_t i, bool value) {
+        return value ? set(i) : reset(i);
+    }
+
+    dynamic_bitset& reset(std::size_t i) {
+        words[i / bits_per_word] &= ~(word_type(1) << (i % bits_per_word));
+        return *this;
+    }
+
+    dynamic_bitset& flip(std::size_t i) {
+        words[i / bits_per_word] ^= word_type(1) << (i % bits_per_word);
+        return *this;
+    }
+
+    /**
+     * @brief Set every bit.
+     */
+    dynamic_bitset& set() {
+        std::fill(words.begin(), words.end(), ~word_type(0));
+        clear_unused_bits();
+        return *this;
+    }
+
+    /**
+     * @brief Clear every bit.
+     */
+    dynamic_bitset& reset() {
+        std::fill(words.begin(), words.end(), word_type(0));
+        return *this;
+    }
+
+    /**
+     * @brief Flip every bit.
+     */
+    dynamic_bitset& flip() {
+        for (word_type& word : words) word = ~word;
+        clear_unused_bits();
+        return *this;
+    }
+
+    /**
+     * @brief Amount of set bits.
+     */
+    std::size_t count() const {
+        return plib::popcount(std::span<word_type const>(words));
+    }
+
+    bool any() const {
+        return std::any_of(words.begin(), words.end(), [](word_type w) { return w != 0; });
+    }
+
+    bool none() const {
+        return !any();
+    }
+
+    bool all() const {
+        return count() == bit_count;
+    }
+
+    /**
+     * @brief Index of the first set bit, or npos if no bit is set.
+     */
+    std::size_t find_first() const {
+        return find_from_word(0);
+    }
+
+    /**
+     * @brief Index of the first set bit after i, or npos if there is none.
+     */
+    std::size_t find_next(std::size_t i) const {
+        ++i;
+        if (i >= bit_count) return npos;
+        std::size_t const w = i / bits_per_word;
+        word_type const word = words[w] & (~word_type(0) << (i % bits_per_word));
+        if (word) return w * bits_per_word + static_cast<std::size_t>(std::countr_zero(word));
+        return find_from_word(w + 1);
+    }
+
+    /**
+     * @brief Range over the indices of all set bits. for (std::size_t i : set.set_bits()) { ... }
+     */
+    set_bit_range set_bits() const {
+        return { set_bit_iterator(this, find_first()) };
+    }
+
+    /**
+     * @brief Call f(index) for every set bit. Faster than iterating set_bits() since it works on one word at a time.
+     */
+    template<typename F>
+    void for_each_set(F&& f) const {
+        for (std::size_t w = 0; w < words.size(); ++w) {
+            word_type word = words[w];
+            while (word) {
+                f(w * bits_per_word + static_cast<std::size_t>(std::countr_zero(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // Whole-set operations. Both sets must have the same size.
+
+    dynamic_bitset& operator&=(dynamic_bitset const& rhs) {
+        check_size(rhs);
+        plib::bit_and(words, rhs.words);
+        return *this;
+    }
+
+    dynamic_bitset& operator|=(dynamic_bitset const& rhs) {
+        check_size(rhs);
+        plib::bit_or(words, rhs.words);
+        return *this;
+    }
+
+    dynamic_bitset& operator^=(dynamic_bitset const& rhs) {
+        check_size(rhs);
+        plib::bit_xor(words, rhs.words);
+        return *this;
+    }
+
+    /**
+     * @brief Clear every bit that is set in rhs (this &= ~rhs).
+     */
+    dynamic_bitset& and_not(dynamic_bitset const& rhs) {
+        check_size(rhs);
+        plib::bit_and_not(words, rhs.words);
+        return *this;
+    }
+
+    friend dynamic_bitset operator&(dynamic_bitset lhs, dynamic_bitset const& rhs) {
+        return lhs &= rhs;
+    }
+
+    friend dynamic_bitset operator|(dynamic_bitset lhs, dynamic_bitset const& rhs) {
+        return lhs |= rhs;
+    }
+
+    friend dynamic_bitset operator^(dynamic_bitset lhs, dynamic_bitset const& rhs) {
+        return lhs ^= rhs;
+    }
+
+    friend dynamic_bitset operator~(dynamic_bitset set) {
+        return set.flip();
+    }
+
+    friend bool operator==(dynamic_bitset const& lhs, dynamic_bitset const& rhs) {
+        return lhs.bit_count == rhs.bit_count && lhs.words == rhs.words;
+    }
+
+    /**
+     * @brief Underlying words. Bit i is stored in word i / 64 at position i % 64.
+     */
+    std::span<word_type const> data() const {
+        return words;
+    }
+
+    std::size_t word_count() const {
+        return words.size();
+    }
+
+private:
+    std::vector<word_type> words;
+    std::size_t bit_count = 0;
+
+    static std::size_t word_count_for(std::size_t bits) {
+        return (bits + bits_per_word - 1) / bits_per_word;
+    }
+
+    void clear_unused_bits() {
+        if (bit_count % bits_per_word != 0) {
+            words.back() &= ~word_type(0) >> (bits_per_word - bit_count % bits_per_word);
+        }
+    }
+
+    void check_size(dynamic_bitset const& rhs) const {
+        if (rhs.bit_count != bit_count) throw std::invalid_argument("dynamic_bitset sizes do not match");
+    }
+
+    std::size_t find_from_word(std::size_t w) const {
+        for (; w < words.size(); ++w) {
+            if (words[w]) return w * bits_per_word + static_cast<std::size_t>(std::countr_zero(words[w]));
+        }
+        return npos;
+    }
+};
+
+/**
+ * @brief Rank/select acceleration structure for a dynamic_bitset. Stores the amount of set bits before every block of 512 bits,
+ *        which makes rank O(1) and select O(log n). Adds 12.5% on top of the bitset's memory.
+ *        The index refers to the bitset it was built from and has to be rebuilt after that bitset changes.
+ */
+class bitset_rank_index {
+public:
+    static constexpr std::size_t words_per_block = 8;
+    static constexpr std::size_t bits_per_block = words_per_block * dynamic_bitset::bits_per_word;
+
+    bitset_rank_index() = default;
+
+    explicit bitset_rank_index(dynamic_bitset const& set) {
+        build(set);
+    }
+
+    void build(dynamic_bitset const& set) {
+        words = set.data();
+        std::size_t const blocks = (words.size() + words_per_block - 1) / words_per_block;
+        block_rank.resize(blocks + 1);
+        block_rank[0] = 0;
+        for (std::size_t b = 0; b < blocks; ++b) {
+            std::size_t const first = b * words_per_block;
+            std::size_t const n = std::min(words_per_block, words.size() - first);
+            block_rank[b + 1] = block_rank[b] + plib::popcount(words.subspan(first, n));
+        }
+    }
+
+    /**
+     * @brief Amount of set bits in [0, pos). pos may be equal to the size of the bitset.
+     */
+    std::size_t rank(std::size_t pos) const {
+        std::size_t const block = pos / bits_per_block;
+        std::size_t const word = pos / dynamic_bitset::bits_per_word;
+        std::size_t result = block_rank[block];
+        for (std::size_t w = block * words_per_block; w < word; ++w) {
+            result += static_cast<std::size_t>(std::popcount(words[w]));
+        }
+        if (pos % dynamic_bitset::bits_per_word != 0) {
+            result += static_cast<std::size_t>(std::popcount(words[word] & (~std::uint64_t(0) >> (dynamic_bitset::bits_per_word - pos % dynamic_bitset::bits_per_word))));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Position of the k-th (0-based) set bit, or dynamic_bitset::npos if fewer than k + 1 bits are set.
+     */
+    std::size_t select(std::size_t k) const {
+        if (k >= count()) return dynamic_bitset::npos;
+        // Last block whose rank is <= k.
+        std::size_t const block = static_cast<std::size_t>(std::upper_bound(block_rank.begin(), block_rank.end(), k) - block_rank.begin()) - 1;
+        std::size_t remaining = k - block_rank[block];
+        for (std::size_t w = block * words_per_block; w < words.size(); ++w) {
+            std::size_t const bits = static_cast<std::size_t>(std::popcount(words[w]));
+            if (remaining < bits) {
+                return w * dynamic_bitset::bits_per_word + detail::bitset_kernels::select_in_word(words[w], static_cast<unsigned>(remaining));
+            }
+            remaining -= bits;
+        }
+        return dynamic_bitset::npos;
+    }
+
+    /**
+     * @brief Total amount of set bits.
+     */
+    std::size_t count() const {
+        return block_rank.empty() ? 0 : block_rank.back();
+    }
+
+private:
+    std::span<std::uint64_t const> words;
+    std::vector<std::size_t> block_rank;
+};
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <plib/traits.hpp>
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+namespace plib {
+
+/**
+ * @brief Map from every enumerator in enum_range<E> to a T, stored as a flat array indexed by the enumerator.
+ *        Unlike an associative container every key always has a value, default constructed until assigned.
+ * @tparam E Enum type. enum_range<E> must be valid for it.
+ * @tparam T Value type.
+ */
+template<typename E, typename T>
+class enum_map {
+public:
+    using key_type = E;
+    using mapped_type = T;
+    using iterator = typename std::array<T, enum_size_v<E>>::iterator;
+    using const_iterator = typename std::array<T, enum_size_v<E>>::const_iterator;
+
+    constexpr enum_map() = default;
+
+    constexpr enum_map(std::initializer_list<std::pair<E, T>> values) {
+        for (auto const& [key, value] : values) (*this)[key] = value;
+    }
+
+    constexpr T& operator[](E key) {
+        return values[enum_index(key)];
+    }
+
+    constexpr T const& operator[](E key) const {
+        return values[enum_index(key)];
+    }
+
+    /**
+     * @brief Bounds-checked access. Throws std::out_of_range if key is outside enum_range<E>.
+     */
+    constexpr T& at(E key) {
+        check_key(key);
+        return values[enum_index(key)];
+    }
+
+    constexpr T const& at(E key) const {
+        check_key(key);
+        return values[enum_index(key)];
+    }
+
+    static constexpr std::size_t size() {
+        return enum_size_v<E>;
+    }
+
+    constexpr void fill(T const& value) {
+        values.fill(value);
+    }
+
+    /**
+     * @brief Call f(E, T&) for every key, in increasing order.
+     */
+    template<typename F>
+    constexpr void for_each(F&& f) {
+        for (std::size_t i = 0; i < values.size(); ++i) f(enum_from_index<E>(i), values[i]);
+    }
+
+    template<typename F>
+    constexpr void for_each(F&& f) const {
+        for (std::size_t i = 0; i < values.size(); ++i) f(enum_from_index<E>(i), values[i]);
+    }
+
+    // Iterators over the values, in key order.
+
+    constexpr iterator begin() { return values.begin(); }
+    constexpr iterator end() { return values.end(); }
+    constexpr const_iterator begin() const { return values.begin(); }
+    constexpr const_iterator end() const { return values.end(); }
+
+    friend constexpr bool operator==(enum_map const& lhs, enum_map const& rhs) = default;
+
+private:
+    std::array<T, enum_size_v<E>> values {};
+
+    static constexpr void check_key(E key) {
+        auto const raw = static_cast<underlying_type_t<E>>(key);
+        if (raw < enum_range<E>::min || raw > enum_range<E>::max) throw std::out_of_range("Key outside of enum_range");
+    }
+};
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <plib/traits.hpp>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace plib {
+
+/**
+ * @brief Set of enumerators stored as a packed bitmask, one bit per enumerator in enum_range<E>.
+ *        Every operation is constexpr and works on a handful of words, there is no hashing and no allocation.
+ * @tparam E Enum type. enum_range<E> must be valid for it.
+ */
+template<typename E>
+class enum_set {
+public:
+    using enum_type = E;
+
+    static constexpr std::size_t capacity = enum_size_v<E>;
+
+    constexpr enum_set() = default;
+
+    constexpr enum_set(std::initializer_list<E> values) {
+        for (E value : values) insert(value);
+    }
+
+    /**
+     * @brief A set containing every enumerator in the range.
+     */
+    static constexpr enum_set all() {
+        return ~enum_set {};
+    }
+
+    constexpr bool contains(E value) const {
+        std::size_t const i = enum_index(value);
+        return (words[i / 64] >> (i % 64)) & 1;
+    }
+
+    constexpr enum_set& insert(E value) {
+        std::size_t const i = enum_index(value);
+        words[i / 64] |= std::uint64_t(1) << (i % 64);
+        return *this;
+    }
+
+    constexpr enum_set& erase(E value) {
+        std::size_t const i = enum_index(value);
+        words[i / 64] &= ~(std::uint64_t(1) << (i % 64));
+        return *this;
+    }
+
+    constexpr enum_set& toggle(E value) {
+        std::size_t const i = enum_index(value);
+        words[i / 64] ^= std::uint64_t(1) << (i % 64);
+        return *this;
+    }
+
+    constexpr void clear() {
+        words = {};
+    }
+
+    constexpr std::size_t size() const {
+        std::size_t result = 0;
+        for (std::uint64_t word : words) result += static_cast<std::size_t>(std::popcount(word));
+        return result;
+    }
+
+    constexpr bool empty() const {
+        for (std::uint64_t word : words) {
+            if (word) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Call f(E) for every enumerator in the set, in increasing order.
+     */
+    template<typename F>
+    constexpr void for_each(F&& f) const {
+        for (std::size_t w = 0; w < word_count; ++w) {
+            std::uint64_t word = words[w];
+            while (word) {
+                f(enum_from_index<E>(w * 64 + static_cast<std::size_t>(std::countr_zero(word))));
+                word &= word - 1;
+            }
+        }
+    }
+
+    constexpr enum_set& operator|=(enum_set const& rhs) {
+        for (std::size_t w = 0; w < word_count; ++w) words[w] |= rhs.words[w];
+        return *this;
+    }
+
+    constexpr enum_set& operator&=(enum_set const& rhs) {
+        for (std::size_t w = 0; w < word_count; ++w) words[w] &= rhs.words[w];
+        return *this;
+    }
+
+    constexpr enum_set& operator^=(enum_set const& rhs) {
+        for (std::size_t w = 0; w < word_count; ++w) words[w] ^= rhs.words[w];
+        return *this;
+    }
+
+    friend constexpr enum_set operator|(enum_set lhs, enum_set const& rhs) {
+        return lhs |= rhs;
+    }
+
+    friend constexpr enum_set operator&(enum_set lhs, enum_set const& rhs) {
+        return lhs &= rhs;
+    }
+
+    friend constexpr enum_set operator^(enum_set lhs, enum_set const& rhs) {
+        return lhs ^= rhs;
+    }
+
+    friend constexpr enum_set operator~(enum_set set) {
+        for (std::uint64_t& word : set.words) word = ~word;
+        if constexpr (capacity % 64 != 0) {
+            set.words[word_count - 1] &= ~std::uint64_t(0) >> (64 - capacity % 64);
+        }
+        return set;
+    }
+
+    friend constexpr bool operator==(enum_set const& lhs, enum_set const& rhs) = default;
+
+private:
+    static constexpr std::size_t word_count = (capacity + 63) / 64;
+
+    std::array<std::uint64_t, word_count> words {};
+};
+
+}
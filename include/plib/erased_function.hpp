@@ -1,66 +1,166 @@
 #pragma once
 
+#include <plib/memory.hpp>
 #include <plib/traits.hpp>
+
+#include <array>
+#include <concepts>
+#include <cstddef>
 #include <functional>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace plib {
 
+namespace detail {
+
+template<typename V>
+void check_arity(std::span<V const> args, std::size_t arity) {
+    if (args.size() != arity) {
+        throw std::invalid_argument("Argument count does not match function arity");
+    }
+}
+
+template<typename V>
+void check_columns(std::span<std::span<V const> const> columns, std::size_t arity, std::size_t count) {
+    if (columns.size() != arity) {
+        throw std::invalid_argument("Column count does not match function arity");
+    }
+    for (std::span<V const> column : columns) {
+        if (column.size() < count) throw std::invalid_argument("Column is shorter than the amount of rows");
+    }
+}
+
+} // namespace detail
+
 /**
- * @brief Callable type-erased function. V is the variant type used for values. Max amount of arguments supported is 8.
+ * @brief Callable type-erased function. V is the variant type used for values.
  * @tparam V variant type for values. Needs to have a static_cast<T> defined to access types.
  */
 template<typename V>
 class erased_function {
 public:
-    virtual V call() { return V {}; }
-    virtual V call(V v) { return V {}; }
-    virtual V call(V v1, V v2) { return V {}; }
-    virtual V call(V v1, V v2, V v3) { return V {}; }
-    virtual V call(V v1, V v2, V v3, V v4) { return V {}; }
-    virtual V call(V v1, V v2, V v3, V v4, V v5) { return V {}; }
-    virtual V call(V v1, V v2, V v3, V v4, V v5, V v6) { return V {}; }
-    virtual V call(V v1, V v2, V v3, V v4, V v5, V v6, V v7) { return V {}; }
-    virtual V call(V v1, V v2, V v3, V v4, V v5, V v6, V v7, V v8) { return V {}; }
+    /**
+     * @brief Call the function.
+     * @param args Arguments to the function. The amount of arguments must match the arity of the function.
+     * @param ret Pointer to store the return value in. May be nullptr to discard it. Left untouched for functions without a return type.
+     */
+    virtual void call(std::span<V const> args, V* ret) = 0;
+
+    /**
+     * @brief Amount of arguments the function takes.
+     */
+    virtual std::size_t arity() const = 0;
+
+    /**
+     * @brief Call the function once for every row of a column-wise argument table.
+     *        The default implementation gathers each row and calls call(), implementations with known argument types
+     *        override this with a loop that does not go through virtual dispatch per row.
+     * @param count Amount of rows.
+     * @param columns One span per parameter, each holding at least count values. Throws std::invalid_argument otherwise.
+     * @param results Pointer to count values to store the return values in. May be nullptr to discard them.
+     */
+    virtual void call_batch(std::size_t count, std::span<std::span<V const> const> columns, V* results) {
+        detail::check_columns(columns, arity(), count);
+        std::vector<V> row(columns.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            for (std::size_t arg = 0; arg < columns.size(); ++arg) {
+                row[arg] = columns[arg][i];
+            }
+            call(std::span<V const>(row), results ? results + i : nullptr);
+        }
+    }
+
+    /**
+     * @brief Convenience overload that packs the arguments and returns the result.
+     *        Prefer call(span, V*) in hot paths, this copies every argument once.
+     */
+    template<typename... Ts> requires (std::convertible_to<Ts, V> && ...)
+    V call(Ts&&... args) {
+        std::array<V, sizeof...(Ts)> values { V(std::forward<Ts>(args))... };
+        V result {};
+        call(std::span<V const>(values), &result);
+        return result;
+    }
 
     // call function with no return type
-    virtual void call_void() {}
-    virtual void call_void(V v1) {}
-    virtual void call_void(V v1, V v2) {}
-    virtual void call_void(V v1, V v2, V v3) {}
-    virtual void call_void(V v1, V v2, V v3, V v4) {}
-    virtual void call_void(V v1, V v2, V v3, V v4, V v5) {}
-    virtual void call_void(V v1, V v2, V v3, V v4, V v5, V v6) {}
-    virtual void call_void(V v1, V v2, V v3, V v4, V v5, V v6, V v7) {}
-    virtual void call_void(V v1, V v2, V v3, V v4, V v5, V v6, V v7, V v8) {}
+    template<typename... Ts> requires (std::convertible_to<Ts, V> && ...)
+    void call_void(Ts&&... args) {
+        std::array<V, sizeof...(Ts)> values { V(std::forward<Ts>(args))... };
+        call(std::span<V const>(values), nullptr);
+    }
 
     virtual ~erased_function() = default;
 };
 
-template<typename F, typename V, typename ValuesPack>
+namespace detail {
+
+// Default callback for creating a V from a return value.
+template<typename V>
+struct construct_value {
+    template<typename R>
+    V operator()(R&& value) const {
+        return V(std::forward<R>(value));
+    }
+};
+
+} // namespace detail
+
+template<typename F, typename V, typename ValuesPack, typename Create = detail::construct_value<V>>
 class concrete_function;
 
 namespace detail {
 
-template<typename R, typename Args, typename Values>
+// Type an argument is static_cast to before it is passed as a parameter of type Arg. Reference parameters of a type V only
+// converts to explicitly (such as std::string const& from a plib::value) get a temporary that lives until the call returns.
+template<typename Arg, typename V>
+using cast_type = std::conditional_t<std::is_convertible_v<V const&, Arg>, Arg, std::remove_cvref_t<Arg>>;
+
+template<typename R, typename Args, typename Fn = void>
 struct call_func;
 
-template<typename R, typename... Args, typename... Values>
-struct call_func<R, pack<Args...>, pack<Values...>> {
+// Fn is the stored callable. Defaults to a plain function pointer.
+template<typename R, typename... Args, typename Fn>
+struct call_func<R, pack<Args...>, Fn> {
+    using function_type = std::conditional_t<std::is_void_v<Fn>, R (*)(Args...), Fn>;
 
-    R (* function)(Args...) = nullptr;
+    function_type function {};
 
-    R operator()(Values& ... values) {
-        return function(static_cast<Args>(values) ...);
+    // Unpacks the arguments from the span at compile time, no intermediate copies of V are made.
+    template<typename V>
+    R operator()(std::span<V const> values) const {
+        return call(values, std::index_sequence_for<Args...> {});
     }
-};
 
-// Specialization for no return type
-template<typename... Args, typename... Values>
-struct call_func<void, pack<Args...>, pack<Values...>> {
-    void (* function)(Args...) = nullptr;
+    // Calls the function for every row of the columns and passes each return value to store(row, value).
+    template<typename V, typename Store>
+    void batch(std::size_t count, std::span<std::span<V const> const> columns, Store&& store) const {
+        batch(count, columns, store, std::index_sequence_for<Args...> {});
+    }
+
+private:
+    template<typename V, std::size_t... I>
+    R call([[maybe_unused]] std::span<V const> values, std::index_sequence<I...>) const {
+        return std::invoke(function, static_cast<cast_type<Args, V>>(values[I]) ...);
+    }
 
-    void operator()(Values& ... values) {
-        return function(static_cast<Args>(values) ...);
+    template<typename V, typename Store, std::size_t... I>
+    void batch(std::size_t count, [[maybe_unused]] std::span<std::span<V const> const> columns, Store& store, std::index_sequence<I...>) const {
+        // Resolve the column pointers once so the loop only indexes raw arrays.
+        [[maybe_unused]] V const* const data[sizeof...(Args) + 1] = { columns[I].data()... };
+        for (std::size_t row = 0; row < count; ++row) {
+            if constexpr (std::is_void_v<R>) {
+                std::invoke(function, static_cast<cast_type<Args, V>>(data[I][row]) ...);
+            } else {
+                store(row, std::invoke(function, static_cast<cast_type<Args, V>>(data[I][row]) ...));
+            }
+        }
     }
 };
 
@@ -72,16 +172,29 @@ struct call_func<void, pack<Args...>, pack<Values...>> {
  * @tparam R Return type of the function
  * @tparam Args Arguments to the function.
  * @tparam Values Pack of sizeof...(Args) instances of V. Provided if you use make_concrete_function
+ * @tparam Create Type of the callback creating a V from an R. make_concrete_function passes the exact type so the call is resolved at compile time.
+ *         The callback is stored by its exact type, so naming the type without Create, as in
+ *         concrete_function<R(Args...), V, pack<...>>(f, callback), only accepts the default callback. A different callback needs
+ *         Create spelled out, class template argument deduction (concrete_function(f, callback) deduces V from the callback's
+ *         return type), or make_concrete_function. Before Create existed the callback was a std::function<V(R const&)>, which
+ *         accepted any callback at the cost of a type-erased call per return value.
  */
-template<typename V, typename R, typename... Args, typename... Values>
-class concrete_function<R(Args...), V, pack<Values...>> : public erased_function<V> {
+template<typename V, typename R, typename... Args, typename... Values, typename Create>
+class concrete_function<R(Args...), V, pack<Values...>, Create> : public erased_function<V> {
 public:
     static_assert(sizeof... (Args) == sizeof... (Values), "Size must match");
 
-    template<typename CreateFunc>
-    concrete_function(R (*f)(Args...), CreateFunc&& c) {
+    using erased_function<V>::call;
+
+    // With the default Create the callback can be left out. Other callbacks need their exact type as Create,
+    // make_concrete_function deduces it.
+    explicit concrete_function(R (*f)(Args...)) requires std::default_initializable<Create> {
+        function = f;
+    }
+
+    template<typename CreateFunc> requires std::constructible_from<Create, CreateFunc>
+    concrete_function(R (*f)(Args...), CreateFunc&& c) : create_value(std::forward<CreateFunc>(c)) {
         function = f;
-        create_value = c;
     }
 
     ~concrete_function() override = default;
@@ -90,20 +203,39 @@ public:
         return call(values...);
     }
 
-    V call(Values... values) override {
-        detail::call_func<R, pack<Args...>, typename make_pack<sizeof...(Args), V>::type> caller { function };
-        return create_value(caller(values...));
+    void call(std::span<V const> args, V* ret) override {
+        detail::check_arity(args, sizeof...(Args));
+        detail::call_func<R, pack<Args...>> caller { function };
+        if (ret) *ret = create_value(caller(args));
+        else caller(args);
+    }
+
+    void call_batch(std::size_t count, std::span<std::span<V const> const> columns, V* results) override {
+        detail::check_columns(columns, sizeof...(Args), count);
+        detail::call_func<R, pack<Args...>> caller { function };
+        if (results) caller.batch(count, columns, [&](std::size_t row, R const& value) { results[row] = create_value(value); });
+        else caller.batch(count, columns, [](std::size_t, R const&) {});
+    }
+
+    std::size_t arity() const override {
+        return sizeof...(Args);
     }
 
     R (*function)(Args...) = nullptr;
-    std::function<V(R const&)> create_value;
+    Create create_value;
 };
 
-template<typename V, typename... Args, typename... Values>
-class concrete_function<void(Args...), V, pack<Values...>> : public erased_function<V> {
+template<typename V, typename... Args, typename... Values, typename Create>
+class concrete_function<void(Args...), V, pack<Values...>, Create> : public erased_function<V> {
 public:
     static_assert(sizeof... (Args) == sizeof... (Values), "Size must match");
 
+    using erased_function<V>::call;
+
+    explicit concrete_function(void (*f)(Args...)) {
+        function = f;
+    }
+
     // create func parameter ignored
     template<typename CreateFunc>
     concrete_function(void (*f)(Args...), CreateFunc&&) {
@@ -116,17 +248,31 @@ public:
         return call(values...);
     }
 
-    V call(Values... values) override {
-        detail::call_func<void, pack<Args...>, typename make_pack<sizeof...(Args), V>::type> caller { function };
-        // call the function
-        caller(values...);
-        // return default value
-        return V {};
+    // No return value, so ret is never written and no value has to be created.
+    void call(std::span<V const> args, V*) override {
+        detail::check_arity(args, sizeof...(Args));
+        detail::call_func<void, pack<Args...>> caller { function };
+        caller(args);
+    }
+
+    void call_batch(std::size_t count, std::span<std::span<V const> const> columns, V*) override {
+        detail::check_columns(columns, sizeof...(Args), count);
+        detail::call_func<void, pack<Args...>> caller { function };
+        caller.batch(count, columns, [](std::size_t) {});
+    }
+
+    std::size_t arity() const override {
+        return sizeof...(Args);
     }
 
     void (*function)(Args...) = nullptr;
 };
 
+// Deduces V from what the callback returns: plib::concrete_function f(&abs, [](int x) { return plib::value(x); });
+template<typename R, typename... Args, typename C> requires (!std::is_void_v<R>)
+concrete_function(R (*)(Args...), C) -> concrete_function<R(Args...), std::invoke_result_t<C&, R>,
+    typename make_pack<sizeof...(Args), std::invoke_result_t<C&, R>>::type, C>;
+
 /**
  * @brief Create a concrete function used for type erasing functions.
  * @tparam V Value type for passing arguments to call().
@@ -139,7 +285,232 @@ public:
  */
 template<typename V, typename R, typename C, typename... Args>
 auto make_concrete_function(R (*function)(Args...), C&& create_func) {
-    return new concrete_function<R(Args...), V, typename make_pack<sizeof...(Args), V>::type>(function, std::forward<C>(create_func));
+    return new concrete_function<R(Args...), V, typename make_pack<sizeof...(Args), V>::type, std::decay_t<C>>(function, std::forward<C>(create_func));
+}
+
+/**
+ * @brief Create a concrete function in memory from a memory resource, such as a plib::monotonic_arena.
+ * @param resource Resource to allocate the object from. Must outlive the returned pointer.
+ * @return Owning pointer to the concrete_function. Converts to allocated_ptr<erased_function<V>>.
+ */
+template<typename V, typename R, typename C, typename... Args>
+auto make_concrete_function(R (*function)(Args...), C&& create_func, std::pmr::memory_resource* resource) {
+    using function_type = concrete_function<R(Args...), V, typename make_pack<sizeof...(Args), V>::type, std::decay_t<C>>;
+    return allocate_unique<function_type>(resource, function, std::forward<C>(create_func));
+}
+
+namespace detail {
+
+template<typename F, typename Args>
+struct bound_member;
+
+// Pairs a member function with the object it is called on.
+template<typename F, typename... Args>
+struct bound_member<F, pack<Args...>> {
+    using class_type = typename function_traits<F>::class_type;
+
+    F method;
+    class_type* object;
+
+    typename function_traits<F>::return_type operator()(Args... args) const {
+        return std::invoke(method, object, std::forward<Args>(args)...);
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Wraps any callable with a deducible signature: function pointers, function objects and lambdas (including capturing ones).
+ *        The callable and the value creation callback are stored by value, so calling it involves no further indirection.
+ * @tparam V Value type used for passing arguments to call().
+ * @tparam F Type of the callable.
+ * @tparam Create Type of the callback creating a V from the return value of F.
+ */
+template<typename V, typename F, typename Create = detail::construct_value<V>>
+class callable_function : public erased_function<V> {
+public:
+    using return_type = typename function_traits<F>::return_type;
+    using argument_types = typename function_traits<F>::argument_types;
+
+    using erased_function<V>::call;
+
+    callable_function(F f, Create c = {}) : function(std::move(f)), create_value(std::move(c)) {}
+
+    // Declared explicitly since the destructor suppresses the implicit move constructor. Without it moves fall back to copying,
+    // and callables that only have a non-throwing move (such as lambdas capturing a std::string) would not fit an inline_function.
+    callable_function(callable_function const&) = default;
+    callable_function(callable_function&&) noexcept(std::is_nothrow_move_constructible_v<F> && std::is_nothrow_move_constructible_v<Create>) = default;
+
+    ~callable_function() override = default;
+
+    void call(std::span<V const> args, V* ret) override {
+        detail::check_arity(args, function_traits<F>::arity);
+        detail::call_func<return_type, argument_types, std::reference_wrapper<F>> caller { std::ref(function) };
+        if constexpr (std::is_void_v<return_type>) {
+            caller(args);
+        } else {
+            if (ret) *ret = create_value(caller(args));
+            else caller(args);
+        }
+    }
+
+    void call_batch(std::size_t count, std::span<std::span<V const> const> columns, V* results) override {
+        detail::check_columns(columns, function_traits<F>::arity, count);
+        detail::call_func<return_type, argument_types, std::reference_wrapper<F>> caller { std::ref(function) };
+        if (results) {
+            caller.batch(count, columns, [&](std::size_t row, auto&& value) { results[row] = create_value(std::forward<decltype(value)>(value)); });
+        } else {
+            caller.batch(count, columns, [](std::size_t, auto&&) {});
+        }
+    }
+
+    std::size_t arity() const override {
+        return function_traits<F>::arity;
+    }
+
+    F function;
+    [[no_unique_address]] Create create_value;
+};
+
+/**
+ * @brief Owning handle to an erased_function. The function is stored in an inline buffer if it fits,
+ *        and only falls back to a heap allocation for large captures.
+ * @tparam V Value type used for passing arguments to call().
+ * @tparam BufferSize Size of the inline buffer in bytes. This includes the vtable pointer of the erased_function.
+ */
+template<typename V, std::size_t BufferSize = 64>
+class inline_function {
+public:
+    static constexpr std::size_t buffer_size = BufferSize;
+
+    /**
+     * @brief Query whether an erased_function of type T is stored inline instead of on the heap.
+     */
+    template<typename T>
+    static constexpr bool fits_inline = sizeof(T) <= BufferSize && alignof(T) <= alignof(std::max_align_t)
+        && std::is_nothrow_move_constructible_v<T>;
+
+    inline_function() = default;
+
+    /**
+     * @brief Construct a T in place. T must derive from erased_function<V>.
+     */
+    template<typename T, typename... A> requires std::derived_from<T, erased_function<V>>
+    explicit inline_function(std::in_place_type_t<T>, A&&... args) {
+        if constexpr (fits_inline<T>) {
+            function = new (buffer) T(std::forward<A>(args)...);
+            relocate = &relocate_impl<T>;
+        } else {
+            function = new T(std::forward<A>(args)...);
+        }
+    }
+
+    inline_function(inline_function const&) = delete;
+    inline_function& operator=(inline_function const&) = delete;
+
+    inline_function(inline_function&& rhs) noexcept {
+        take(rhs);
+    }
+
+    inline_function& operator=(inline_function&& rhs) noexcept {
+        if (this != &rhs) {
+            reset();
+            take(rhs);
+        }
+        return *this;
+    }
+
+    ~inline_function() {
+        reset();
+    }
+
+    erased_function<V>* get() const {
+        return function;
+    }
+
+    erased_function<V>* operator->() const {
+        return function;
+    }
+
+    erased_function<V>& operator*() const {
+        return *function;
+    }
+
+    explicit operator bool() const {
+        return function != nullptr;
+    }
+
+    /**
+     * @brief Query whether the stored function lives in the inline buffer.
+     */
+    bool is_inline() const {
+        return relocate != nullptr;
+    }
+
+    /**
+     * @brief Destroy the stored function, leaving this handle empty.
+     */
+    void reset() {
+        if (!function) return;
+        if (is_inline()) function->~erased_function();
+        else delete function;
+        function = nullptr;
+        relocate = nullptr;
+    }
+
+private:
+    alignas(std::max_align_t) std::byte buffer[BufferSize];
+    erased_function<V>* function = nullptr;
+    // Moves an inline function to another buffer and destroys the original. nullptr if the function is on the heap.
+    erased_function<V>* (*relocate)(std::byte* from, std::byte* to) = nullptr;
+
+    template<typename T>
+    static erased_function<V>* relocate_impl(std::byte* from, std::byte* to) {
+        T* source = std::launder(reinterpret_cast<T*>(from));
+        T* result = new (to) T(std::move(*source));
+        source->~T();
+        return result;
+    }
+
+    void take(inline_function& rhs) {
+        if (rhs.is_inline()) function = rhs.relocate(rhs.buffer, buffer);
+        else function = rhs.function;
+        relocate = rhs.relocate;
+        rhs.function = nullptr;
+        rhs.relocate = nullptr;
+    }
+};
+
+/**
+ * @brief Create an inline_function wrapping a callable.
+ * @tparam V Value type for passing arguments to call().
+ * @tparam BufferSize Size of the inline buffer of the returned handle.
+ * @param function Function pointer, function object or lambda to wrap. Its signature must be deducible.
+ * @param create_func Callback to create a V from the return value. Defaults to constructing a V from it.
+ * @return inline_function owning the wrapped callable.
+ */
+template<typename V, std::size_t BufferSize = 64, typename F, typename C = detail::construct_value<V>>
+    requires (!std::is_member_function_pointer_v<std::decay_t<F>>)
+inline_function<V, BufferSize> make_function(F&& function, C&& create_func = {}) {
+    using function_type = callable_function<V, std::decay_t<F>, std::decay_t<C>>;
+    return inline_function<V, BufferSize>(std::in_place_type<function_type>, std::forward<F>(function), std::forward<C>(create_func));
+}
+
+/**
+ * @brief Create an inline_function calling a member function on an object.
+ * @tparam V Value type for passing arguments to call().
+ * @tparam BufferSize Size of the inline buffer of the returned handle.
+ * @param method Member function to call.
+ * @param object Object to call the member function on. Must outlive the returned function.
+ * @param create_func Callback to create a V from the return value. Defaults to constructing a V from it.
+ * @return inline_function owning the wrapped call.
+ */
+template<typename V, std::size_t BufferSize = 64, typename M, typename C = detail::construct_value<V>>
+    requires std::is_member_function_pointer_v<M>
+inline_function<V, BufferSize> make_function(M method, typename function_traits<M>::class_type* object, C&& create_func = {}) {
+    using bound_type = detail::bound_member<M, typename function_traits<M>::argument_types>;
+    using function_type = callable_function<V, bound_type, std::decay_t<C>>;
+    return inline_function<V, BufferSize>(std::in_place_type<function_type>, bound_type { method, object }, std::forward<C>(create_func));
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,620 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define PLIB_FLAT_HASH_SSE2 1
+#endif
+
+namespace plib {
+
+/**
+ * @brief Transparent hash for string keys, so maps with std::string keys can be searched with a std::string_view
+ *        or a string literal without constructing a std::string.
+ */
+struct string_hash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view str) const noexcept {
+        return std::hash<std::string_view> {}(str);
+    }
+};
+
+namespace detail {
+
+template<typename K>
+struct default_flat_hash {
+    using type = std::hash<K>;
+};
+
+template<>
+struct default_flat_hash<std::string> {
+    using type = string_hash;
+};
+
+template<>
+struct default_flat_hash<std::string_view> {
+    using type = string_hash;
+};
+
+// Control byte of a slot. Empty slots have the high bit set, full slots store the low 7 bits of the hash.
+using ctrl_t = std::int8_t;
+inline constexpr ctrl_t ctrl_empty = -128;
+
+/**
+ * @brief 16 consecutive control bytes, matched against a value all at once.
+ *        Bit i of a returned mask corresponds to the i-th control byte of the group.
+ */
+class ctrl_group {
+public:
+    static constexpr std::size_t width = 16;
+
+    explicit ctrl_group(ctrl_t const* ctrl) noexcept {
+#if defined(PLIB_FLAT_HASH_SSE2)
+        bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(ctrl));
+#else
+        std::memcpy(bytes, ctrl, width);
+#endif
+    }
+
+    std::uint32_t match(ctrl_t h2) const noexcept {
+#if defined(PLIB_FLAT_HASH_SSE2)
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2))));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < width; ++i) mask |= std::uint32_t(bytes[i] == h2) << i;
+        return mask;
+#endif
+    }
+
+    std::uint32_t match_empty() const noexcept {
+#if defined(PLIB_FLAT_HASH_SSE2)
+        // Only empty slots have the sign bit set.
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(bytes));
+#else
+        return match(ctrl_empty);
+#endif
+    }
+
+    std::uint32_t match_full() const noexcept {
+        return ~match_empty() & 0xFFFF;
+    }
+
+private:
+#if defined(PLIB_FLAT_HASH_SSE2)
+    __m128i bytes;
+#else
+    ctrl_t bytes[width];
+#endif
+};
+
+// splitmix64 finalizer. std::hash is the identity for integers on common standard libraries,
+// which would put consecutive keys in consecutive slots and leave the 7 hash bits in the control bytes constant.
+inline std::uint64_t flat_hash_mix(std::uint64_t h) noexcept {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+} // namespace detail
+
+/**
+ * @brief Open addressing hash map storing keys and values inline in a single allocation, for exact-match lookups.
+ *        Every slot has a one byte control word holding 7 bits of the key's hash, lookups compare 16 control bytes at a time
+ *        (with SSE2 where available) and only compare keys whose control byte matches.
+ *        Slots are probed linearly from the key's home slot, which lets erase() close the gap by shifting later entries back
+ *        instead of leaving tombstones, so lookups never slow down after many erasures.
+ *        Like other open addressing maps, inserting or erasing invalidates all iterators and references.
+ *        Elements are std::pair<K const, V> like in std::unordered_map, so it->second and for (auto& [key, value] : map) can modify values.
+ * @tparam K Key type.
+ * @tparam V Mapped type.
+ * @tparam Hash Hash function. The default for std::string keys is string_hash, which allows lookups by std::string_view.
+ * @tparam KeyEqual Key comparison. find() and friends accept any key type if both Hash and KeyEqual are transparent.
+ */
+template<typename K, typename V, typename Hash = typename detail::default_flat_hash<K>::type, typename KeyEqual = std::equal_to<>>
+class flat_hash_map {
+    // Keys of other types can be looked up if both the hash and the comparison accept them.
+    template<typename Key>
+    static constexpr bool lookup_key = std::is_convertible_v<Key const&, K const&> || requires {
+        typename Hash::is_transparent;
+        typename KeyEqual::is_transparent;
+    };
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K const, V>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+    template<bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename flat_hash_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, value_type const*, value_type*>;
+        using reference = std::conditional_t<Const, value_type const&, value_type&>;
+
+        basic_iterator() = default;
+
+        // A const_iterator can be created from an iterator.
+        template<bool OtherConst> requires (Const && !OtherConst)
+        basic_iterator(basic_iterator<OtherConst> const& rhs) : map(rhs.map), index(rhs.index) {}
+
+        /**
+         * @brief Access the key and value. The key is const, the value can be modified through a mutable iterator.
+         */
+        reference operator*() const {
+            return map->slots[index].value;
+        }
+
+        pointer operator->() const {
+            return &map->slots[index].value;
+        }
+
+        /**
+         * @brief Shorthand for (*it).second.
+         */
+        std::conditional_t<Const, V const&, V&> value() const {
+            return map->slots[index].value.second;
+        }
+
+        basic_iterator& operator++() {
+            index = map->next_full(index + 1);
+            return *this;
+        }
+
+        basic_iterator operator++(int) {
+            basic_iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        friend bool operator==(basic_iterator const& lhs, basic_iterator const& rhs) {
+            return lhs.index == rhs.index;
+        }
+
+    private:
+        friend class flat_hash_map;
+        friend class basic_iterator<!Const>;
+
+        using map_pointer = std::conditional_t<Const, flat_hash_map const*, flat_hash_map*>;
+
+        basic_iterator(map_pointer map, std::size_t index) : map(map), index(index) {}
+
+        map_pointer map = nullptr;
+        std::size_t index = 0;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    flat_hash_map() = default;
+
+    /**
+     * @brief Create a map with room for at least count elements before it has to grow.
+     */
+    explicit flat_hash_map(std::size_t count) {
+        reserve(count);
+    }
+
+    flat_hash_map(std::initializer_list<value_type> values) {
+        reserve(values.size());
+        for (value_type const& value : values) insert(value);
+    }
+
+    flat_hash_map(flat_hash_map const& rhs) : hash(rhs.hash), eq(rhs.eq) {
+        reserve(rhs.size());
+        for (value_type const& value : rhs) insert_unique(value.first, value.second);
+    }
+
+    flat_hash_map(flat_hash_map&& rhs) noexcept
+        : hash(std::move(rhs.hash)), eq(std::move(rhs.eq)),
+          ctrl(std::exchange(rhs.ctrl, nullptr)), slots(std::exchange(rhs.slots, nullptr)),
+          cap(std::exchange(rhs.cap, 0)), element_count(std::exchange(rhs.element_count, 0)) {}
+
+    flat_hash_map& operator=(flat_hash_map const& rhs) {
+        if (this != &rhs) {
+            flat_hash_map copy(rhs);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    flat_hash_map& operator=(flat_hash_map&& rhs) noexcept {
+        if (this != &rhs) {
+            destroy();
+            hash = std::move(rhs.hash);
+            eq = std::move(rhs.eq);
+            ctrl = std::exchange(rhs.ctrl, nullptr);
+            slots = std::exchange(rhs.slots, nullptr);
+            cap = std::exchange(rhs.cap, 0);
+            element_count = std::exchange(rhs.element_count, 0);
+        }
+        return *this;
+    }
+
+    ~flat_hash_map() {
+        destroy();
+    }
+
+    void swap(flat_hash_map& rhs) noexcept {
+        using std::swap;
+        swap(hash, rhs.hash);
+        swap(eq, rhs.eq);
+        swap(ctrl, rhs.ctrl);
+        swap(slots, rhs.slots);
+        swap(cap, rhs.cap);
+        swap(element_count, rhs.element_count);
+    }
+
+    iterator begin() { return iterator(this, next_full(0)); }
+    iterator end() { return iterator(this, cap); }
+    const_iterator begin() const { return const_iterator(this, next_full(0)); }
+    const_iterator end() const { return const_iterator(this, cap); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    std::size_t size() const { return element_count; }
+    bool empty() const { return element_count == 0; }
+
+    /**
+     * @brief Amount of slots. The map grows when more than 7/8 of them are in use.
+     */
+    std::size_t capacity() const { return cap; }
+
+    /**
+     * @brief Remove all elements, keeping the allocation.
+     */
+    void clear() {
+        if (element_count == 0) return;
+        for (std::size_t i = 0; i < cap; ++i) {
+            if (ctrl[i] != detail::ctrl_empty) slots[i].destroy();
+        }
+        std::memset(ctrl, detail::ctrl_empty, cap + detail::ctrl_group::width - 1);
+        element_count = 0;
+    }
+
+    /**
+     * @brief Make room for at least n elements without growing.
+     */
+    void reserve(std::size_t n) {
+        // The smallest power of two capacity that keeps n elements under the maximum load factor.
+        std::size_t needed = detail::ctrl_group::width;
+        while (max_load(needed) < n) needed *= 2;
+        if (needed > cap) rehash(needed);
+    }
+
+    template<typename Key>
+    iterator find(Key const& key) requires lookup_key<Key> {
+        return iterator(this, find_index(key));
+    }
+
+    template<typename Key>
+    const_iterator find(Key const& key) const requires lookup_key<Key> {
+        return const_iterator(this, find_index(key));
+    }
+
+    template<typename Key>
+    bool contains(Key const& key) const requires lookup_key<Key> {
+        return find_index(key) != cap;
+    }
+
+    template<typename Key>
+    std::size_t count(Key const& key) const requires lookup_key<Key> {
+        return contains(key) ? 1 : 0;
+    }
+
+    /**
+     * @brief Access the value of a key. Throws std::out_of_range if the key is not in the map.
+     */
+    template<typename Key>
+    V& at(Key const& key) requires lookup_key<Key> {
+        std::size_t const index = find_index(key);
+        if (index == cap) throw std::out_of_range("Key not found in flat_hash_map");
+        return slots[index].value.second;
+    }
+
+    template<typename Key>
+    V const& at(Key const& key) const requires lookup_key<Key> {
+        std::size_t const index = find_index(key);
+        if (index == cap) throw std::out_of_range("Key not found in flat_hash_map");
+        return slots[index].value.second;
+    }
+
+    /**
+     * @brief Access the value of a key, inserting a default constructed value if the key is not in the map.
+     */
+    V& operator[](K const& key) {
+        return try_emplace(key).first.value();
+    }
+
+    V& operator[](K&& key) {
+        return try_emplace(std::move(key)).first.value();
+    }
+
+    /**
+     * @brief Insert a key with a value constructed from args, if the key is not in the map yet.
+     * @return Iterator to the element with the key, and true if it was inserted.
+     */
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(K const& key, Args&&... args) {
+        return emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        return emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(value_type const& value) {
+        return emplace_impl(value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return emplace_impl(std::move(value.first), std::move(value.second));
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(K const& key, M&& value) {
+        auto result = emplace_impl(key, std::forward<M>(value));
+        if (!result.second) result.first.value() = std::forward<M>(value);
+        return result;
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& value) {
+        auto result = emplace_impl(std::move(key), std::forward<M>(value));
+        if (!result.second) result.first.value() = std::forward<M>(value);
+        return result;
+    }
+
+    /**
+     * @brief Erase a key.
+     * @return The amount of erased elements, 0 or 1.
+     */
+    template<typename Key>
+    std::size_t erase(Key const& key) requires lookup_key<Key> && (!std::is_convertible_v<Key const&, const_iterator>) {
+        std::size_t const index = find_index(key);
+        if (index == cap) return 0;
+        erase_at(index);
+        return 1;
+    }
+
+    /**
+     * @brief Erase the element an iterator points to. Later elements may be moved into its slot, so all iterators are invalidated.
+     *        Use erase_if() to erase elements while iterating.
+     */
+    void erase(const_iterator pos) {
+        erase_at(pos.index);
+    }
+
+    /**
+     * @brief Erase every element for which pred(element) returns true.
+     * @return The amount of erased elements.
+     */
+    template<typename Pred>
+    std::size_t erase_if(Pred pred) {
+        if (element_count == 0) return 0;
+        // Erasing shifts elements backwards, towards the start of their run of full slots. Visiting slots backwards,
+        // starting right before an empty slot, guarantees every element that gets shifted has already been visited.
+        std::size_t start = 0;
+        while (ctrl[start] != detail::ctrl_empty) ++start;
+        std::size_t erased = 0;
+        for (std::size_t n = 0, i = start; n < cap; ++n) {
+            i = (i - 1) & (cap - 1);
+            if (ctrl[i] != detail::ctrl_empty && pred(static_cast<value_type const&>(slots[i].value))) {
+                erase_at(i);
+                ++erased;
+            }
+        }
+        return erased;
+    }
+
+    hasher hash_function() const { return hash; }
+    key_equal key_eq() const { return eq; }
+
+private:
+    using mutable_value_type = std::pair<K, V>;
+
+    // The element is constructed as a std::pair<K, V> and handed out as a std::pair<K const, V>, the two are layout compatible.
+    // Relocating elements during rehash and erase goes through the non-const pair, so keys are moved instead of copied.
+    union slot_type {
+        slot_type() {}
+        ~slot_type() {}
+
+        value_type value;
+        mutable_value_type mutable_value;
+
+        template<typename... Args>
+        void construct(Args&&... args) {
+            new (&mutable_value) mutable_value_type(std::forward<Args>(args)...);
+        }
+
+        void destroy() {
+            mutable_value.~mutable_value_type();
+        }
+    };
+
+    static_assert(sizeof(value_type) == sizeof(mutable_value_type) && alignof(value_type) == alignof(mutable_value_type));
+
+    [[no_unique_address]] Hash hash {};
+    [[no_unique_address]] KeyEqual eq {};
+    // Control bytes, followed by a copy of the first width - 1 of them, so a group can be loaded from any slot without wrapping.
+    detail::ctrl_t* ctrl = nullptr;
+    slot_type* slots = nullptr;
+    std::size_t cap = 0;
+    std::size_t element_count = 0;
+
+    static constexpr std::size_t max_load(std::size_t capacity) {
+        return capacity - capacity / 8;
+    }
+
+    template<typename Key>
+    std::uint64_t hash_of(Key const& key) const {
+        return detail::flat_hash_mix(static_cast<std::uint64_t>(hash(key)));
+    }
+
+    static detail::ctrl_t h2(std::uint64_t hash) {
+        return static_cast<detail::ctrl_t>(hash & 0x7F);
+    }
+
+    std::size_t home_slot(std::uint64_t hash) const {
+        return static_cast<std::size_t>(hash >> 7) & (cap - 1);
+    }
+
+    void set_ctrl(std::size_t index, detail::ctrl_t value) {
+        ctrl[index] = value;
+        if (index < detail::ctrl_group::width - 1) ctrl[cap + index] = value;
+    }
+
+    template<typename Key>
+    std::size_t find_index(Key const& key) const {
+        if (element_count == 0) return cap;
+        std::uint64_t const hash = hash_of(key);
+        detail::ctrl_t const tag = h2(hash);
+        std::size_t pos = home_slot(hash);
+        while (true) {
+            detail::ctrl_group const group(ctrl + pos);
+            for (std::uint32_t match = group.match(tag); match; match &= match - 1) {
+                std::size_t const index = (pos + static_cast<std::size_t>(std::countr_zero(match))) & (cap - 1);
+                if (eq(slots[index].value.first, key)) return index;
+            }
+            // Elements never live past the first empty slot after their home slot.
+            if (group.match_empty()) return cap;
+            pos = (pos + detail::ctrl_group::width) & (cap - 1);
+        }
+    }
+
+    // First empty slot at or after the home slot of a hash. There always is one, the load factor stays below 1.
+    std::size_t find_empty(std::uint64_t hash) const {
+        std::size_t pos = home_slot(hash);
+        while (true) {
+            std::uint32_t const empty = detail::ctrl_group(ctrl + pos).match_empty();
+            if (empty) return (pos + static_cast<std::size_t>(std::countr_zero(empty))) & (cap - 1);
+            pos = (pos + detail::ctrl_group::width) & (cap - 1);
+        }
+    }
+
+    std::size_t next_full(std::size_t index) const {
+        while (index < cap) {
+            std::uint32_t const full = detail::ctrl_group(ctrl + index).match_full();
+            if (full) return std::min(index + static_cast<std::size_t>(std::countr_zero(full)), cap);
+            index += detail::ctrl_group::width;
+        }
+        return cap;
+    }
+
+    template<typename Key, typename... Args>
+    std::pair<iterator, bool> emplace_impl(Key&& key, Args&&... args) {
+        std::size_t const existing = find_index(key);
+        if (existing != cap) return { iterator(this, existing), false };
+        if (element_count + 1 > max_load(cap)) rehash(cap ? cap * 2 : detail::ctrl_group::width);
+        std::size_t const index = insert_unique(std::forward<Key>(key), std::forward<Args>(args)...);
+        return { iterator(this, index), true };
+    }
+
+    // Insert a key that is known not to be in the map, with enough capacity left.
+    template<typename Key, typename... Args>
+    std::size_t insert_unique(Key&& key, Args&&... args) {
+        std::uint64_t const hash = hash_of(key);
+        std::size_t const index = find_empty(hash);
+        slots[index].construct(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                               std::forward_as_tuple(std::forward<Args>(args)...));
+        set_ctrl(index, h2(hash));
+        ++element_count;
+        return index;
+    }
+
+    void erase_at(std::size_t hole) {
+        slots[hole].destroy();
+        set_ctrl(hole, detail::ctrl_empty);
+        --element_count;
+        // Backward shift: move later elements of the run into the hole if that does not move them before their home slot.
+        std::size_t const mask = cap - 1;
+        for (std::size_t next = (hole + 1) & mask; ctrl[next] != detail::ctrl_empty; next = (next + 1) & mask) {
+            std::size_t const home = home_slot(hash_of(slots[next].value.first));
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole].construct(std::move(slots[next].mutable_value));
+                slots[next].destroy();
+                set_ctrl(hole, ctrl[next]);
+                set_ctrl(next, detail::ctrl_empty);
+                hole = next;
+            }
+        }
+    }
+
+    static std::size_t slots_offset(std::size_t capacity) {
+        std::size_t const ctrl_bytes = capacity + detail::ctrl_group::width - 1;
+        return (ctrl_bytes + alignof(slot_type) - 1) / alignof(slot_type) * alignof(slot_type);
+    }
+
+    // Over-aligned value types need the aligned allocation functions, everything else uses the regular ones.
+    static constexpr bool over_aligned = alignof(slot_type) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static void* allocate(std::size_t bytes) {
+        if constexpr (over_aligned) return ::operator new(bytes, std::align_val_t(alignof(slot_type)));
+        else return ::operator new(bytes);
+    }
+
+    static void deallocate(void* memory) {
+        if constexpr (over_aligned) ::operator delete(memory, std::align_val_t(alignof(slot_type)));
+        else ::operator delete(memory);
+    }
+
+    void rehash(std::size_t new_capacity) {
+        std::byte* memory = static_cast<std::byte*>(allocate(slots_offset(new_capacity) + new_capacity * sizeof(slot_type)));
+        detail::ctrl_t* old_ctrl = std::exchange(ctrl, reinterpret_cast<detail::ctrl_t*>(memory));
+        slot_type* old_slots = std::exchange(slots, reinterpret_cast<slot_type*>(memory + slots_offset(new_capacity)));
+        std::size_t const old_capacity = std::exchange(cap, new_capacity);
+        std::memset(ctrl, detail::ctrl_empty, cap + detail::ctrl_group::width - 1);
+        element_count = 0;
+
+        for (std::size_t i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] == detail::ctrl_empty) continue;
+            insert_unique(std::move(old_slots[i].mutable_value.first), std::move(old_slots[i].mutable_value.second));
+            old_slots[i].destroy();
+        }
+        if (old_ctrl) deallocate(old_ctrl);
+    }
+
+    void destroy() {
+        if (!ctrl) return;
+        clear();
+        deallocate(ctrl);
+        ctrl = nullptr;
+        slots = nullptr;
+        cap = 0;
+    }
+};
+
+/**
+ * @brief Erase every element of a flat_hash_map for which pred(element) returns true.
+ * @return The amount of erased elements.
+ */
+template<typename K, typename V, typename Hash, typename KeyEqual, typename Pred>
+std::size_t erase_if(flat_hash_map<K, V, Hash, KeyEqual>& map, Pred pred) {
+    return map.erase_if(pred);
+}
+
+}
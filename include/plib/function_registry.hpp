@@ -0,0 +1,338 @@
+#pragma once
+
+#include <plib/erased_function.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace plib {
+
+/**
+ * @brief Id returned by name lookups that did not find anything.
+ */
+inline constexpr std::uint32_t invalid_function_id = std::numeric_limits<std::uint32_t>::max();
+
+namespace detail {
+
+// splitmix64 finalizer
+constexpr std::uint64_t mix_hash(std::uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+// FNV-1a, usable at compile time.
+constexpr std::uint64_t name_hash(std::string_view name) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return mix_hash(h);
+}
+
+// The name is only hashed once, the seeded hash selecting the final slot is derived from that.
+constexpr std::size_t perfect_hash_slot(std::uint64_t h, std::uint32_t seed, std::size_t n) {
+    return static_cast<std::size_t>(mix_hash(h + seed * 0x9e3779b97f4a7c15ull) % n);
+}
+
+constexpr std::uint32_t empty_slot = std::numeric_limits<std::uint32_t>::max();
+
+// Seeds tried per bucket before giving up. Distinct hashes are practically always placed within a few hundred tries,
+// running out means two different names hash to the same 64-bit value.
+constexpr std::uint32_t max_seed_attempts = 1u << 16;
+
+enum class perfect_hash_result {
+    ok,
+    duplicate_name,
+    no_seed_found
+};
+
+/*
+ * Build a minimal perfect hash over n names using hash-and-displace. Names are distributed over n buckets by their hash,
+ * then buckets are placed from largest to smallest by searching for a seed that maps every name in the bucket to a free slot.
+ * Looking up a name is then: slot = perfect_hash_slot(h, seeds[h % n], n), and slots[slot] holds the index of the name.
+ * Works on any indexable containers so it can run both at compile time on std::array and at runtime on std::vector.
+ * All containers must hold at least n elements, bucket_start must hold n + 1.
+ */
+template<typename Names, typename Table, typename Scratch, typename BucketStart>
+constexpr perfect_hash_result build_perfect_hash(Names const& names, std::size_t n, Table& seeds, Table& slots,
+                                  Scratch& hashes, BucketStart& bucket_start, Scratch& order, Scratch& bucket_order) {
+    if (n == 0) return perfect_hash_result::ok;
+
+    for (std::size_t i = 0; i <= n; ++i) bucket_start[i] = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        hashes[i] = name_hash(names[i]);
+        ++bucket_start[hashes[i] % n + 1];
+        slots[i] = empty_slot;
+        seeds[i] = 0;
+    }
+
+    // Counting sort of names by bucket. bucket_order temporarily holds the insert cursor of each bucket.
+    std::size_t max_bucket = 0;
+    for (std::size_t b = 0; b < n; ++b) {
+        max_bucket = std::max<std::size_t>(max_bucket, bucket_start[b + 1]);
+        bucket_start[b + 1] += bucket_start[b];
+        bucket_order[b] = bucket_start[b];
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        order[bucket_order[hashes[i] % n]++] = i;
+    }
+
+    // Duplicate names always end up in the same bucket.
+    for (std::size_t b = 0; b < n; ++b) {
+        for (std::size_t i = bucket_start[b]; i < bucket_start[b + 1]; ++i) {
+            for (std::size_t j = i + 1; j < bucket_start[b + 1]; ++j) {
+                if (std::string_view(names[order[i]]) == std::string_view(names[order[j]])) return perfect_hash_result::duplicate_name;
+            }
+        }
+    }
+
+    // Place the largest buckets first, while the table is still mostly empty.
+    std::size_t placed = 0;
+    for (std::size_t size = max_bucket; size > 0; --size) {
+        for (std::size_t b = 0; b < n; ++b) {
+            if (bucket_start[b + 1] - bucket_start[b] == size) bucket_order[placed++] = b;
+        }
+    }
+
+    for (std::size_t p = 0; p < placed; ++p) {
+        std::size_t const b = bucket_order[p];
+        for (std::uint32_t seed = 1;; ++seed) {
+            if (seed > max_seed_attempts) return perfect_hash_result::no_seed_found;
+            std::size_t i = bucket_start[b];
+            for (; i < bucket_start[b + 1]; ++i) {
+                std::size_t const slot = perfect_hash_slot(hashes[order[i]], seed, n);
+                if (slots[slot] != empty_slot) break;
+                slots[slot] = static_cast<std::uint32_t>(order[i]);
+            }
+            if (i == bucket_start[b + 1]) {
+                seeds[b] = seed;
+                break;
+            }
+            // Conflict, undo the slots taken with this seed and try the next one.
+            for (std::size_t j = bucket_start[b]; j < i; ++j) {
+                slots[perfect_hash_slot(hashes[order[j]], seed, n)] = empty_slot;
+            }
+        }
+    }
+    return perfect_hash_result::ok;
+}
+
+template<typename Names, typename Table>
+constexpr std::uint32_t perfect_hash_lookup(Names const& names, Table const& seeds, Table const& slots, std::size_t n, std::string_view name) {
+    if (n == 0) return invalid_function_id;
+    std::uint64_t const h = name_hash(name);
+    std::uint32_t const index = slots[perfect_hash_slot(h, seeds[h % n], n)];
+    // The perfect hash only separates known names, an unknown name still needs one comparison to be rejected.
+    if (std::string_view(names[index]) != name) return invalid_function_id;
+    return index;
+}
+
+} // namespace detail
+
+/**
+ * @brief Compile-time table of names with a minimal perfect hash. Use make_name_table() to create one.
+ *        The id of a name is its index in the list the table was created from.
+ * @tparam N Amount of names in the table.
+ */
+template<std::size_t N>
+class static_name_table {
+public:
+    constexpr explicit static_name_table(std::array<std::string_view, N> const& names) : names(names) {
+        std::array<std::uint64_t, N> hashes {};
+        std::array<std::uint64_t, N + 1> bucket_start {};
+        std::array<std::uint64_t, N> order {};
+        std::array<std::uint64_t, N> bucket_order {};
+        switch (detail::build_perfect_hash(names, N, seeds, slots, hashes, bucket_start, order, bucket_order)) {
+        case detail::perfect_hash_result::ok: break;
+        case detail::perfect_hash_result::duplicate_name: throw std::invalid_argument("Duplicate name in static_name_table");
+        case detail::perfect_hash_result::no_seed_found: throw std::runtime_error("No perfect hash found for static_name_table, two names have the same hash");
+        }
+    }
+
+    /**
+     * @brief Look up the id of a name.
+     * @param name Name to look up.
+     * @return The index of the name, or invalid_function_id if it is not in the table.
+     */
+    constexpr std::uint32_t index_of(std::string_view name) const {
+        return detail::perfect_hash_lookup(names, seeds, slots, N, name);
+    }
+
+    /**
+     * @brief The name with the given id. Throws std::logic_error if the id is not in the table.
+     */
+    constexpr std::string_view name(std::uint32_t id) const {
+        if (id >= N) throw std::logic_error("Invalid static_name_table id");
+        return names[id];
+    }
+
+    static constexpr std::size_t size() {
+        return N;
+    }
+
+private:
+    template<typename V, std::size_t BufferSize>
+    friend class function_registry;
+
+    std::array<std::string_view, N> names {};
+    std::array<std::uint32_t, N> seeds {};
+    std::array<std::uint32_t, N> slots {};
+};
+
+namespace detail {
+
+template<std::size_t N, std::size_t... I>
+consteval static_name_table<N> make_name_table(std::string_view const (&names)[N], std::index_sequence<I...>) {
+    return static_name_table<N>(std::array<std::string_view, N> { names[I]... });
+}
+
+} // namespace detail
+
+/**
+ * @brief Build a static_name_table at compile time.
+ *        Example: constexpr auto names = plib::make_name_table({ "print", "len" }); constexpr auto print_id = names.index_of("print");
+ * @param names Names in the table. Compilation fails if a name occurs twice.
+ */
+template<std::size_t N>
+consteval static_name_table<N> make_name_table(std::string_view const (&names)[N]) {
+    return detail::make_name_table(names, std::make_index_sequence<N> {});
+}
+
+/**
+ * @brief Registry mapping names to type-erased functions. Names are resolved once to a stable integer id through a
+ *        minimal perfect hash, after which functions are dispatched by index without any string comparisons.
+ * @tparam V Value type used for passing arguments to the functions.
+ * @tparam BufferSize Inline buffer size of the stored inline_function objects.
+ */
+template<typename V, std::size_t BufferSize = 64>
+class function_registry {
+public:
+    using function_type = inline_function<V, BufferSize>;
+
+    function_registry() = default;
+
+    /**
+     * @brief Create a registry with the names from a static table. Their ids are the same as in the table,
+     *        so ids computed at compile time can be used directly. Bind functions to them with bind().
+     */
+    template<std::size_t N>
+    explicit function_registry(static_name_table<N> const& table) {
+        names.reserve(N);
+        for (std::string_view name : table.names) names.emplace_back(name);
+        functions.resize(N);
+        seeds.assign(table.seeds.begin(), table.seeds.end());
+        slots.assign(table.slots.begin(), table.slots.end());
+        dirty = false;
+    }
+
+    /**
+     * @brief Register a new function. The hash table is rebuilt on the next call to build().
+     * @param name Name of the function.
+     * @param function Function to register.
+     * @return Id of the function. Ids are assigned in registration order and never change.
+     */
+    std::uint32_t add(std::string_view name, function_type function) {
+        names.emplace_back(name);
+        functions.push_back(std::move(function));
+        dirty = true;
+        return static_cast<std::uint32_t>(functions.size() - 1);
+    }
+
+    /**
+     * @brief Replace the function stored under an id.
+     */
+    void bind(std::uint32_t id, function_type function) {
+        functions.at(id) = std::move(function);
+    }
+
+    /**
+     * @brief Rebuild the perfect hash after registering functions. Throws std::invalid_argument if a name was registered twice,
+     *        and std::runtime_error in the (practically impossible) case that no perfect hash is found.
+     */
+    void build() {
+        if (!dirty) return;
+
+        std::size_t const n = names.size();
+        seeds.resize(n);
+        slots.resize(n);
+        std::vector<std::uint64_t> hashes(n), bucket_start(n + 1), order(n), bucket_order(n);
+        switch (detail::build_perfect_hash(names, n, seeds, slots, hashes, bucket_start, order, bucket_order)) {
+        case detail::perfect_hash_result::ok: break;
+        case detail::perfect_hash_result::duplicate_name: throw std::invalid_argument("Duplicate name in function_registry");
+        case detail::perfect_hash_result::no_seed_found: throw std::runtime_error("No perfect hash found for function_registry, two names have the same hash");
+        }
+        dirty = false;
+    }
+
+    /**
+     * @brief Resolve a name to its id. Intended to be done once per call site, dispatch through the id afterwards.
+     * @param name Name of the function.
+     * @return The id of the function, or invalid_function_id if there is no function with this name.
+     */
+    std::uint32_t resolve(std::string_view name) const {
+        if (dirty) throw std::logic_error("function_registry::build() must be called after registering functions");
+        return detail::perfect_hash_lookup(names, seeds, slots, names.size(), name);
+    }
+
+    /**
+     * @brief The function with the given id. Throws std::logic_error if the id is invalid_function_id or unknown,
+     *        or if no function is bound to the id.
+     */
+    erased_function<V>& operator[](std::uint32_t id) const {
+        return bound(id);
+    }
+
+    /**
+     * @brief Call the function with the given id.
+     * @param id Id obtained from add() or resolve().
+     * @param args Arguments to the function.
+     * @param ret Pointer to store the return value in, may be nullptr.
+     *        Throws std::logic_error if the id is invalid_function_id or unknown, or if no function is bound to the id.
+     */
+    void call(std::uint32_t id, std::span<V const> args, V* ret) const {
+        bound(id).call(args, ret);
+    }
+
+    /**
+     * @brief The name registered under the given id. Throws std::logic_error if the id was not returned by add() or resolve().
+     */
+    std::string const& name(std::uint32_t id) const {
+        if (id >= names.size()) throw std::logic_error("Invalid function_registry id");
+        return names[id];
+    }
+
+    std::size_t size() const {
+        return functions.size();
+    }
+
+private:
+    // Ids from a static_name_table exist before a function is bound to them.
+    // A failed resolve() returns invalid_function_id, which has to throw instead of indexing past the end.
+    erased_function<V>& bound(std::uint32_t id) const {
+        if (id >= functions.size()) throw std::logic_error("Invalid function_registry id");
+        function_type const& function = functions[id];
+        if (!function) throw std::logic_error("No function bound to this function_registry id");
+        return *function;
+    }
+
+    std::vector<std::string> names;
+    std::vector<function_type> functions;
+    std::vector<std::uint32_t> seeds;
+    std::vector<std::uint32_t> slots;
+    bool dirty = false;
+};
+
+}
@@ -1,13 +1,33 @@
 #pragma once
 
-#ifndef __has_builtin
-#define __has_builtin(_) 0
+// __has_builtin can only be used after checking it is defined, MSVC and GCC before 10 do not have it.
+#if defined(__has_builtin)
+#    define PLIB_HAS_BUILTIN(x) __has_builtin(x)
+#else
+#    define PLIB_HAS_BUILTIN(x) 0
 #endif
 
-#if __has_builtin(__builtin_unreachable)
+#if PLIB_HAS_BUILTIN(__builtin_unreachable)
 #    define PLIB_UNREACHABLE() __builtin_unreachable()
 #elif MSVC
 #    define PLIB_UNREACHABLE() __assume(0)
 #else
 #    define PLIB_UNREACHABLE()
-#endif
\ No newline at end of file
+#endif
+#define PLIB_CONCAT_IMPL(a, b) a##b
+#define PLIB_CONCAT(a, b) PLIB_CONCAT_IMPL(a, b)
+
+// Profiling macros, see plib/profile.hpp. Without PLIB_ENABLE_PROFILE they expand to nothing.
+#if defined(PLIB_ENABLE_PROFILE)
+// Time the enclosing scope. The name must be a string literal.
+#    define PLIB_PROFILE_ZONE(name) ::plib::profile::scoped_zone PLIB_CONCAT(plib_profile_zone_, __LINE__)(name)
+// Add an amount to a named counter. The counter is looked up once per call site.
+#    define PLIB_PROFILE_COUNTER(name, amount)                                                                     \
+        do {                                                                                                       \
+            static ::plib::profile::counter& plib_profile_counter = ::plib::profile::get_counter(name);           \
+            plib_profile_counter.add(amount);                                                                      \
+        } while (false)
+#else
+#    define PLIB_PROFILE_ZONE(name) static_cast<void>(0)
+#    define PLIB_PROFILE_COUNTER(name, amount) static_cast<void>(0)
+#endif
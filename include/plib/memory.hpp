@@ -0,0 +1,379 @@
+#pragma once
+
+#include <plib/types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace plib {
+
+/**
+ * @brief Deleter for objects created with allocate_unique(). Destroys the object and returns its memory to the resource it came from.
+ *        A deleter without a resource uses delete, so pointers that were allocated with new can be adopted as well.
+ * @tparam T Type of the pointer. Deleting through a base class requires a virtual destructor, the size of the most derived
+ *           type is kept by the deleter.
+ */
+template<typename T>
+struct resource_deleter {
+    std::pmr::memory_resource* resource = nullptr;
+    std::size_t size = 0;
+    std::size_t alignment = 0;
+
+    resource_deleter() = default;
+
+    resource_deleter(std::pmr::memory_resource* resource, std::size_t size, std::size_t alignment)
+        : resource(resource), size(size), alignment(alignment) {}
+
+    // Allows converting an allocated_ptr<Derived> into an allocated_ptr<Base>.
+    template<typename U> requires std::is_convertible_v<U*, T*>
+    resource_deleter(resource_deleter<U> const& rhs) : resource(rhs.resource), size(rhs.size), alignment(rhs.alignment) {}
+
+    void operator()(T* ptr) const {
+        if (!resource) {
+            delete ptr;
+            return;
+        }
+        // Go through the most derived object, ptr may point to a base class subobject.
+        void* memory = dynamic_cast_to_void(ptr);
+        ptr->~T();
+        resource->deallocate(memory, size, alignment);
+    }
+
+private:
+    static void* dynamic_cast_to_void(T* ptr) {
+        if constexpr (std::is_polymorphic_v<T>) return dynamic_cast<void*>(ptr);
+        else return ptr;
+    }
+};
+
+/**
+ * @brief Owning pointer to an object allocated from a memory resource.
+ */
+template<typename T>
+using allocated_ptr = std::unique_ptr<T, resource_deleter<T>>;
+
+/**
+ * @brief Create an object in memory from a memory resource.
+ * @param resource Resource to allocate from. Must outlive the returned pointer.
+ * @param args Arguments passed to the constructor of T.
+ */
+template<typename T, typename... Args>
+allocated_ptr<T> allocate_unique(std::pmr::memory_resource* resource, Args&&... args) {
+    void* memory = resource->allocate(sizeof(T), alignof(T));
+    try {
+        T* object = new (memory) T(std::forward<Args>(args)...);
+        return allocated_ptr<T>(object, resource_deleter<T>(resource, sizeof(T), alignof(T)));
+    } catch (...) {
+        resource->deallocate(memory, sizeof(T), alignof(T));
+        throw;
+    }
+}
+
+/**
+ * @brief Bump allocator. Memory is carved out of blocks taken from an upstream resource, and is only given back
+ *        all at once by reset() or release(), which makes it suited for allocations that live for one request or one frame.
+ *        Deallocating a single allocation does nothing. Destructors of objects created in the arena are not run by reset().
+ *        Usable as a std::pmr::memory_resource, for example with std::pmr containers. Not thread-safe.
+ */
+class monotonic_arena : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t default_block_size = 4096;
+
+    /**
+     * @param block_size Size of the first block. Every next block is twice as large as the previous one.
+     * @param upstream Resource the blocks are allocated from.
+     */
+    explicit monotonic_arena(std::size_t block_size = default_block_size, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : upstream(upstream), next_block_size(std::max(block_size, sizeof(block_header) * 2)) {}
+
+    /**
+     * @brief Create an arena that starts out allocating from a caller provided buffer, such as an array on the stack.
+     *        The buffer is never freed by the arena, blocks are only taken from upstream after it is full.
+     */
+    monotonic_arena(void* buffer, std::size_t size, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : upstream(upstream), next_block_size(std::max(size * 2, default_block_size)),
+          initial_buffer(static_cast<std::byte*>(buffer)), initial_size(size) {
+        cursor = initial_buffer;
+        end = initial_buffer + initial_size;
+    }
+
+    monotonic_arena(monotonic_arena const&) = delete;
+    monotonic_arena& operator=(monotonic_arena const&) = delete;
+
+    ~monotonic_arena() override {
+        release();
+    }
+
+    /**
+     * @brief Allocate memory. Never returns nullptr, throws std::bad_alloc if upstream fails.
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+        std::size_t const padding = (alignment - reinterpret_cast<std::uintptr_t>(cursor) % alignment) % alignment;
+        if (!cursor || static_cast<std::size_t>(end - cursor) < padding + bytes) return allocate_slow(bytes, alignment);
+        std::byte* result = cursor + padding;
+        cursor = result + bytes;
+        return result;
+    }
+
+    /**
+     * @brief Allocate and construct an object in the arena. Its destructor is never called by the arena.
+     */
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Free everything allocated so far, but keep the most recently allocated block so the next round of allocations
+     *        does not have to go upstream again.
+     */
+    void reset() {
+        if (!blocks) {
+            cursor = initial_buffer;
+            end = initial_buffer + initial_size;
+            return;
+        }
+        block_header* keep = blocks;
+        free_blocks(keep->previous);
+        keep->previous = nullptr;
+        blocks = keep;
+        cursor = reinterpret_cast<std::byte*>(keep + 1);
+        end = reinterpret_cast<std::byte*>(keep) + keep->size;
+    }
+
+    /**
+     * @brief Free everything allocated so far and return all blocks to the upstream resource.
+     */
+    void release() {
+        free_blocks(blocks);
+        blocks = nullptr;
+        cursor = initial_buffer;
+        end = initial_buffer + initial_size;
+    }
+
+    std::pmr::memory_resource* upstream_resource() const {
+        return upstream;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct alignas(std::max_align_t) block_header {
+        block_header* previous = nullptr;
+        std::size_t size = 0;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::size_t next_block_size;
+    std::byte* initial_buffer = nullptr;
+    std::size_t initial_size = 0;
+
+    block_header* blocks = nullptr;
+    std::byte* cursor = nullptr;
+    std::byte* end = nullptr;
+
+    void* allocate_slow(std::size_t bytes, std::size_t alignment) {
+        // Large allocations get a block that fits them, the regular block size still grows geometrically.
+        std::size_t const size = std::max(next_block_size, sizeof(block_header) + bytes + alignment);
+        auto* block = new (upstream->allocate(size, alignof(block_header))) block_header { blocks, size };
+        blocks = block;
+        next_block_size *= 2;
+        cursor = reinterpret_cast<std::byte*>(block + 1);
+        end = reinterpret_cast<std::byte*>(block) + size;
+        return allocate(bytes, alignment);
+    }
+
+    void free_blocks(block_header* block) {
+        while (block) {
+            block_header* previous = block->previous;
+            upstream->deallocate(block, block->size, alignof(block_header));
+            block = previous;
+        }
+    }
+};
+
+/**
+ * @brief Pool of fixed-size blocks. Freed blocks go on a free list and are handed out again by the next allocation,
+ *        memory is taken from upstream in chunks of many blocks and only returned by release() or the destructor.
+ *        Usable as a std::pmr::memory_resource, requests larger than the block size are forwarded to upstream. Not thread-safe.
+ */
+class pool_resource : public std::pmr::memory_resource {
+public:
+    /**
+     * @param block_size Size of every block in bytes.
+     * @param block_alignment Alignment of every block.
+     * @param blocks_per_chunk Amount of blocks taken from upstream at once.
+     * @param upstream Resource the chunks are allocated from.
+     */
+    explicit pool_resource(std::size_t block_size, std::size_t block_alignment = alignof(std::max_align_t), std::size_t blocks_per_chunk = 256,
+                           std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : upstream(upstream), alignment(std::max(block_alignment, alignof(free_block))),
+          stride(round_up(std::max(block_size, sizeof(free_block)), alignment)), blocks_per_chunk(std::max<std::size_t>(blocks_per_chunk, 1)) {}
+
+    pool_resource(pool_resource const&) = delete;
+    pool_resource& operator=(pool_resource const&) = delete;
+
+    ~pool_resource() override {
+        release();
+    }
+
+    /**
+     * @brief Take a block from the pool.
+     */
+    void* allocate_block() {
+        if (!free_list) refill();
+        free_block* block = free_list;
+        free_list = block->next;
+        return block;
+    }
+
+    /**
+     * @brief Return a block to the pool. The block must have been allocated from this pool.
+     */
+    void deallocate_block(void* ptr) {
+        free_list = new (ptr) free_block { free_list };
+    }
+
+    /**
+     * @brief Return all chunks to upstream. Every block handed out so far becomes invalid.
+     */
+    void release() {
+        while (chunks) {
+            chunk_header* previous = chunks->previous;
+            upstream->deallocate(chunks, chunk_size(), chunk_alignment());
+            chunks = previous;
+        }
+        free_list = nullptr;
+    }
+
+    std::size_t block_size() const {
+        return stride;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        if (bytes > stride || align > alignment) return upstream->allocate(bytes, align);
+        return allocate_block();
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t align) override {
+        if (bytes > stride || align > alignment) upstream->deallocate(ptr, bytes, align);
+        else deallocate_block(ptr);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct free_block {
+        free_block* next;
+    };
+
+    struct chunk_header {
+        chunk_header* previous;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::size_t alignment;
+    std::size_t stride;
+    std::size_t blocks_per_chunk;
+    chunk_header* chunks = nullptr;
+    free_block* free_list = nullptr;
+
+    static std::size_t round_up(std::size_t value, std::size_t multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    // The header is padded to the block alignment so the first block is aligned.
+    std::size_t header_size() const {
+        return round_up(sizeof(chunk_header), alignment);
+    }
+
+    std::size_t chunk_size() const {
+        return header_size() + stride * blocks_per_chunk;
+    }
+
+    std::size_t chunk_alignment() const {
+        return std::max(alignment, alignof(chunk_header));
+    }
+
+    void refill() {
+        auto* chunk = new (upstream->allocate(chunk_size(), chunk_alignment())) chunk_header { chunks };
+        chunks = chunk;
+        std::byte* first = reinterpret_cast<std::byte*>(chunk) + header_size();
+        // Thread the blocks in address order, so consecutive allocations are adjacent in memory.
+        for (std::size_t i = blocks_per_chunk; i > 0; --i) {
+            free_list = new (first + (i - 1) * stride) free_block { free_list };
+        }
+    }
+};
+
+/**
+ * @brief Typed wrapper around a pool_resource, for creating and destroying many objects of the same type.
+ *        Not thread-safe.
+ * @tparam T Type of the objects in the pool.
+ */
+template<typename T>
+class object_pool {
+public:
+    explicit object_pool(std::size_t objects_per_chunk = 256, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : pool(sizeof(T), alignof(T), objects_per_chunk, upstream) {}
+
+    /**
+     * @brief Create an object in the pool.
+     */
+    template<typename... Args>
+    owner<T*> create(Args&&... args) {
+        void* memory = pool.allocate_block();
+        try {
+            return new (memory) T(std::forward<Args>(args)...);
+        } catch (...) {
+            pool.deallocate_block(memory);
+            throw;
+        }
+    }
+
+    /**
+     * @brief Destroy an object created by this pool and return its memory to the pool.
+     */
+    void destroy(owner<T*> object) {
+        if (!object) return;
+        object->~T();
+        pool.deallocate_block(object);
+    }
+
+    /**
+     * @brief Free the memory of every object at once, without running their destructors.
+     */
+    void release() {
+        pool.release();
+    }
+
+    /**
+     * @brief The underlying resource. It only hands out blocks of sizeof(T), larger requests go to upstream.
+     */
+    pool_resource* resource() {
+        return &pool;
+    }
+
+private:
+    pool_resource pool;
+};
+
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <plib/macros.hpp>
+#include <plib/types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(PLIB_PROFILE_USE_STEADY_CLOCK)
+#    define PLIB_PROFILE_RDTSC 1
+#    if defined(_MSC_VER) && !defined(__clang__)
+#        include <intrin.h>
+#    else
+#        include <x86intrin.h>
+#    endif
+#endif
+
+#ifndef PLIB_PROFILE_BUFFER_SIZE
+// Amount of events each thread can buffer between two flushes. Must be a power of two.
+#    define PLIB_PROFILE_BUFFER_SIZE 16384
+#endif
+
+namespace plib::profile {
+
+/**
+ * @brief Raw timestamp. These are TSC ticks on x86 (unless PLIB_PROFILE_USE_STEADY_CLOCK is defined),
+ *        and steady_clock nanoseconds everywhere else. They are converted to time when writing a trace.
+ */
+using tick = std::uint64_t;
+
+inline tick now() noexcept {
+#if defined(PLIB_PROFILE_RDTSC)
+    return __rdtsc();
+#else
+    return static_cast<tick>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * @brief A finished zone, recorded when the zone ends.
+ */
+struct event {
+    char const* name = nullptr;
+    tick begin = 0;
+    tick end = 0;
+};
+
+/**
+ * @brief Named counter that only goes up, shared by all threads.
+ */
+class counter {
+public:
+    explicit counter(std::string_view name) : name(name) {}
+
+    void add(std::uint64_t amount = 1) noexcept {
+        value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    std::uint64_t load() const noexcept {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    std::string const& get_name() const {
+        return name;
+    }
+
+private:
+    std::string name;
+    std::atomic<std::uint64_t> value = 0;
+};
+
+namespace detail {
+
+/**
+ * @brief Single producer, single consumer ring of events. The owning thread pushes without locking,
+ *        the flusher drains it under the registry lock. When the ring is full new events are dropped and counted,
+ *        so recording never blocks.
+ */
+class thread_buffer {
+public:
+    static constexpr std::size_t capacity = PLIB_PROFILE_BUFFER_SIZE;
+    static_assert((capacity & (capacity - 1)) == 0, "PLIB_PROFILE_BUFFER_SIZE must be a power of two");
+
+    explicit thread_buffer(std::uint32_t thread_id) : thread_id(thread_id), events(std::make_unique<event[]>(capacity)) {}
+
+    void push(event const& e) noexcept {
+        std::uint64_t const h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[h & (capacity - 1)] = e;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Only called by the flusher.
+    template<typename F>
+    void drain(F&& f) {
+        std::uint64_t const h = head.load(std::memory_order_acquire);
+        std::uint64_t t = tail.load(std::memory_order_relaxed);
+        for (; t != h; ++t) f(events[t & (capacity - 1)]);
+        tail.store(h, std::memory_order_release);
+    }
+
+    std::uint32_t const thread_id;
+    std::atomic<std::uint64_t> dropped = 0;
+    std::atomic<bool> retired = false;
+
+private:
+    std::unique_ptr<event[]> events;
+    std::atomic<std::uint64_t> head = 0;
+    std::atomic<std::uint64_t> tail = 0;
+};
+
+struct clock_reference {
+    tick ticks = 0;
+    std::chrono::steady_clock::time_point time {};
+
+    static clock_reference capture() {
+        return { now(), std::chrono::steady_clock::now() };
+    }
+};
+
+class registry {
+public:
+    std::shared_ptr<thread_buffer> register_thread() {
+        std::lock_guard lock(mutex);
+        buffers.push_back(std::make_shared<thread_buffer>(next_thread_id++));
+        return buffers.back();
+    }
+
+    counter& get_counter(std::string_view name) {
+        std::lock_guard lock(mutex);
+        for (counter& c : counters) {
+            if (c.get_name() == name) return c;
+        }
+        return counters.emplace_back(name);
+    }
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<thread_buffer>> buffers;
+    // Deque so counters never move, call sites keep references to them.
+    std::deque<counter> counters;
+    std::uint32_t next_thread_id = 1;
+    clock_reference start = clock_reference::capture();
+};
+
+inline registry& global_registry() {
+    static registry instance;
+    return instance;
+}
+
+inline thread_local thread_buffer* current_buffer = nullptr;
+
+// Keeps the buffer of a thread registered until the thread exits, after which the flusher drains and releases it.
+struct buffer_owner {
+    std::shared_ptr<thread_buffer> buffer;
+
+    ~buffer_owner() {
+        if (buffer) buffer->retired.store(true, std::memory_order_release);
+        current_buffer = nullptr;
+    }
+};
+
+inline thread_buffer& register_thread() {
+    thread_local buffer_owner owner;
+    owner.buffer = global_registry().register_thread();
+    current_buffer = owner.buffer.get();
+    return *current_buffer;
+}
+
+inline void write_string(std::string& out, std::string_view str) {
+    out += '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+} // namespace detail
+
+/**
+ * @brief Record a finished zone on the calling thread's buffer. Lock-free after the first event of a thread.
+ * @param name Name of the zone. Only the pointer is stored, so it must stay valid until the trace is written (use string literals).
+ */
+inline void record(char const* name, tick begin, tick end) {
+    detail::thread_buffer* buffer = detail::current_buffer;
+    if (!buffer) buffer = &detail::register_thread();
+    buffer->push({ name, begin, end });
+}
+
+/**
+ * @brief Get the counter with a given name, creating it if it does not exist yet. Takes a lock, look counters up once
+ *        and keep the reference (PLIB_PROFILE_COUNTER does this).
+ */
+inline counter& get_counter(std::string_view name) {
+    return detail::global_registry().get_counter(name);
+}
+
+/**
+ * @brief Times the scope it lives in. Use through PLIB_PROFILE_ZONE so it is compiled out when profiling is disabled.
+ */
+class scoped_zone {
+public:
+    explicit scoped_zone(char const* name) noexcept : name(name), begin(now()) {}
+
+    scoped_zone(scoped_zone const&) = delete;
+    scoped_zone& operator=(scoped_zone const&) = delete;
+
+    ~scoped_zone() {
+        record(name, begin, now());
+    }
+
+private:
+    char const* name;
+    tick begin;
+};
+
+/**
+ * @brief Drain every thread's events and write them, together with the current value of every counter,
+ *        as a Chrome trace JSON document (load it in chrome://tracing or Perfetto).
+ *        Events are removed from the buffers, so every call writes the events recorded since the previous one.
+ * @param out Stream to write to, usually a binary_output_stream. Anything with write_bytes(byte const*, size_t) works.
+ */
+template<typename OutputStream>
+void write_chrome_trace(OutputStream& out) {
+    detail::registry& reg = detail::global_registry();
+    std::lock_guard lock(reg.mutex);
+
+    // Measure the tick rate over the whole lifetime of the registry, which gets more accurate the longer the program runs.
+    detail::clock_reference const end = detail::clock_reference::capture();
+    double const elapsed_us = std::chrono::duration<double, std::micro>(end.time - reg.start.time).count();
+    double const us_per_tick = end.ticks > reg.start.ticks ? elapsed_us / static_cast<double>(end.ticks - reg.start.ticks) : 0.0;
+    auto to_us = [&](tick t) {
+        return t > reg.start.ticks ? static_cast<double>(t - reg.start.ticks) * us_per_tick : 0.0;
+    };
+
+    std::string json;
+    bool first = true;
+    auto begin_event = [&] {
+        if (!first) json += ",\n";
+        first = false;
+    };
+    auto flush_json = [&] {
+        out.write_bytes(reinterpret_cast<byte const*>(json.data()), json.size());
+        json.clear();
+    };
+
+    char number[160];
+    json += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    for (auto& buffer : reg.buffers) {
+        // An exited thread does not record anything anymore, so its buffer can be released after this last drain.
+        bool const retired = buffer->retired.load(std::memory_order_acquire);
+        begin_event();
+        std::snprintf(number, sizeof(number), "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+                      buffer->thread_id, buffer->thread_id);
+        json += number;
+
+        buffer->drain([&](event const& e) {
+            begin_event();
+            json += "{\"ph\":\"X\",\"name\":";
+            detail::write_string(json, e.name);
+            double const ts = to_us(e.begin);
+            std::snprintf(number, sizeof(number), ",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}", ts, std::max(0.0, to_us(e.end) - ts), buffer->thread_id);
+            json += number;
+            if (json.size() >= 64 * 1024) flush_json();
+        });
+
+        if (std::uint64_t const dropped = buffer->dropped.load(std::memory_order_relaxed)) {
+            begin_event();
+            std::snprintf(number, sizeof(number), "{\"ph\":\"C\",\"name\":\"dropped events\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%llu}}",
+                          to_us(end.ticks), buffer->thread_id, static_cast<unsigned long long>(dropped));
+            json += number;
+        }
+        if (retired) buffer.reset();
+    }
+
+    for (counter const& c : reg.counters) {
+        begin_event();
+        json += "{\"ph\":\"C\",\"name\":";
+        detail::write_string(json, c.get_name());
+        std::snprintf(number, sizeof(number), ",\"ts\":%.3f,\"pid\":1,\"tid\":0,\"args\":{\"value\":%llu}}",
+                      to_us(end.ticks), static_cast<unsigned long long>(c.load()));
+        json += number;
+    }
+    json += "\n]}\n";
+    flush_json();
+
+    std::erase(reg.buffers, nullptr);
+}
+
+}
@@ -1,9 +1,15 @@
 #pragma once
 
 #include <plib/types.hpp>
+#include <plib/macros.hpp>
+#include <plib/memory.hpp>
+#if defined(PLIB_ENABLE_PROFILE)
+#include <plib/profile.hpp>
+#endif
 #include <cstring>
 #include <cstdlib>
 #include <stdexcept>
+#include <utility>
 
 #include <algorithm> // TODO: May want to replace this with a lightweight header for common math functions like min(), with added constexpr support for some
 
@@ -113,63 +119,66 @@ namespace plib {
 			binary_input_stream(binary_input_stream const&) = delete;
 			binary_input_stream& operator=(binary_input_stream const&) = delete;
 
-			binary_input_stream(binary_input_stream&& rhs) {
-				fetcher = rhs.fetcher;
-				current_chunk = rhs.current_chunk;
-				offset = rhs.offset;
+			binary_input_stream(binary_input_stream&& rhs)
+				: fetcher(std::move(rhs.fetcher)), current_chunk(std::exchange(rhs.current_chunk, {})), offset(std::exchange(rhs.offset, 0)) {
 
-				rhs.fetcher = nullptr;
-				rhs.current_chunk = {};
-				rhs.offset = 0;
 			}
 
 			binary_input_stream& operator=(binary_input_stream&& rhs) {
 				// Checking the fetcher is enough to verify whether this stream is the same one as rhs.
 				if (rhs.fetcher != fetcher) {
-					fetcher = rhs.fetcher;
-					current_chunk = rhs.current_chunk;
-					offset = rhs.offset;
-
-					rhs.fetcher = nullptr;
-					rhs.current_chunk = {};
-					rhs.offset = 0;
+					fetcher = std::move(rhs.fetcher);
+					current_chunk = std::exchange(rhs.current_chunk, {});
+					offset = std::exchange(rhs.offset, 0);
 				}
 				return *this;
 			}
 
+			// Takes ownership of a fetcher allocated with new
 			binary_input_stream(owner<detail::stream_fetcher<element_type, ChunkSize>*> fetcher)
 				: fetcher(fetcher) {
 
 			}
 
-			static binary_input_stream<ChunkSize> from_memory(byte const* pointer, size_t size) {
+			binary_input_stream(allocated_ptr<detail::stream_fetcher<element_type, ChunkSize>> fetcher)
+				: fetcher(std::move(fetcher)) {
+
+			}
+
+			// The fetcher is allocated from resource, which must outlive the stream.
+			static binary_input_stream<ChunkSize> from_memory(byte const* pointer, size_t size,
+				std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
 				using fetcher_type = detail::memory_stream_fetcher<element_type, ChunkSize>;
 				// Create binary input stream
 				return binary_input_stream<ChunkSize>(
-					// With a memory fetcher. The stream owns this pointer and will delete it on destruction
-					new fetcher_type(pointer, size)
+					// With a memory fetcher. The stream owns this pointer and will destroy it on destruction
+					allocate_unique<fetcher_type>(resource, pointer, size)
 				);
 			}
 
-			static binary_input_stream<ChunkSize> from_file(const char* path) {
+			static binary_input_stream<ChunkSize> from_file(const char* path,
+				std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
 				using fetcher_type = detail::file_stream_fetcher<element_type, ChunkSize>;
 				return binary_input_stream<ChunkSize>(
-					new fetcher_type(path, "rb") // open file in read-binary mode
+					allocate_unique<fetcher_type>(resource, path, "rb") // open file in read-binary mode
 				);
 			}
 
-			~binary_input_stream() {
-				delete fetcher;
-			}
-
 			// Reads n bytes into the destination pointer. Returns the amount of bytes copied.
 			size_t read_bytes(element_type* dst, size_t n) {
+				PLIB_PROFILE_ZONE("binary_input_stream::read_bytes");
 				size_t amount_read = 0;
 				while (amount_read != n) {
 					size_t max_read_this_chunk = current_chunk.size - offset;
 					// If our last chunk was full, or we have never read one, read a new chunk.
 					if (current_chunk.pointer == nullptr || max_read_this_chunk == 0) {
-						current_chunk = fetcher->fetch_chunk();
+						{
+							// Time spent waiting for the next chunk shows up as its own zone inside read_bytes.
+							PLIB_PROFILE_ZONE("binary_input_stream::fetch_chunk");
+							current_chunk = fetcher->fetch_chunk();
+						}
+						PLIB_PROFILE_COUNTER("binary_input_stream chunks fetched", 1);
+						PLIB_PROFILE_COUNTER("binary_input_stream bytes fetched", current_chunk.size);
 						max_read_this_chunk = current_chunk.size;
 						offset = 0;
 					}
@@ -193,7 +202,7 @@ namespace plib {
 			}
 
 		private:
-			owner<detail::stream_fetcher<byte, ChunkSize>*> fetcher = nullptr;
+			allocated_ptr<detail::stream_fetcher<byte, ChunkSize>> fetcher = nullptr;
 			// Current chunk
 			detail::stream_chunk<element_type> current_chunk{};
 			// Current offset in this chunk
@@ -223,8 +232,9 @@ namespace plib {
 
 			~memory_stream_writer() = default;
 
+			// Data that does not fit in the remaining space is dropped.
 			void write_data(T const* pointer, size_t n) override {
-				size_t const to_write = std::min(n, end - cur);
+				size_t const to_write = std::min(n, static_cast<size_t>(end - cur));
 				if (to_write == 0) return;
 				std::memcpy(cur, pointer, to_write * sizeof(T));
 				cur += to_write;
@@ -274,6 +284,7 @@ namespace plib {
 
 			void flush() override {
 				write_buf();
+				offset = 0;
 				fflush(file);
 			}
 
@@ -298,45 +309,49 @@ namespace plib {
 			binary_output_stream(binary_output_stream const&) = delete;
 			binary_output_stream& operator=(binary_output_stream const&) = delete;
 
-			binary_output_stream(binary_output_stream&& rhs) {
-				writer = rhs.writer;
-				rhs.writer = nullptr;
+			binary_output_stream(binary_output_stream&& rhs) : writer(std::move(rhs.writer)) {
+
 			}
 
 			binary_output_stream& operator=(binary_output_stream&& rhs) {
 				// Checking the writer is enough to verify whether this stream is the same one as rhs.
 				if (rhs.writer != writer) {
-					writer = rhs.writer;
-					rhs.writer = nullptr;
+					writer = std::move(rhs.writer);
 				}
 				return *this;
 			}
 
+			// Takes ownership of a writer allocated with new
 			binary_output_stream(owner<detail::stream_writer<element_type, ChunkSize>*> writer)
 				: writer(writer) {
 
 			}
 
-			static binary_output_stream<ChunkSize> from_memory(element_type const* pointer, size_t size) {
+			binary_output_stream(allocated_ptr<detail::stream_writer<element_type, ChunkSize>> writer)
+				: writer(std::move(writer)) {
+
+			}
+
+			// Writes into the size elements at pointer, so the pointer is mutable (taking a const pointer never compiled).
+			// The writer is allocated from resource, which must outlive the stream.
+			static binary_output_stream<ChunkSize> from_memory(element_type* pointer, size_t size,
+				std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
 				using writer_type = detail::memory_stream_writer<element_type, ChunkSize>;
 				// Create binary input stream
 				return binary_output_stream<ChunkSize>(
-					// With a memory writer. The stream owns this pointer and will delete it on destruction
-					new writer_type(pointer, size)
+					// With a memory writer. The stream owns this pointer and will destroy it on destruction
+					allocate_unique<writer_type>(resource, pointer, size)
 				);
 			}
 
-			static binary_output_stream<ChunkSize> from_file(const char* path) {
+			static binary_output_stream<ChunkSize> from_file(const char* path,
+				std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
 				using writer_type = detail::file_stream_writer<element_type, ChunkSize>;
 				return binary_output_stream<ChunkSize>(
-					new writer_type(path, "wb") // open file in write-binary mode
+					allocate_unique<writer_type>(resource, path, "wb") // open file in write-binary mode
 				);
 			}
 
-			~binary_output_stream() {
-				delete writer;
-			}
-
 			void flush() {
 				writer->flush();
 			}
@@ -351,7 +366,7 @@ namespace plib {
 			}
 
 		private:
-			owner<detail::stream_writer<element_type, ChunkSize>*> writer = nullptr;
+			allocated_ptr<detail::stream_writer<element_type, ChunkSize>> writer = nullptr;
 		};
 
 	} // namespace detail
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace plib {
+
+/**
+ * @brief Symbol returned by lookups that did not find anything.
+ */
+inline constexpr std::uint32_t invalid_symbol = std::numeric_limits<std::uint32_t>::max();
+
+namespace detail {
+
+/**
+ * @brief Append-only storage for string bytes. Strings are stored null-terminated and never move, so pointers into
+ *        the arena stay valid for its whole lifetime. Not thread-safe.
+ */
+class string_arena {
+public:
+    static constexpr std::size_t block_size = 64 * 1024;
+
+    char const* append(std::string_view str) {
+        std::size_t const needed = str.size() + 1;
+        if (needed > remaining) {
+            // Strings that do not fit in a regular block get a block of their own, so the current block is not wasted.
+            std::size_t const size = std::max(block_size, needed);
+            blocks.push_back(std::make_unique<char[]>(size));
+            if (size == block_size) {
+                cursor = blocks.back().get();
+                remaining = size;
+            } else {
+                char* dst = blocks.back().get();
+                std::memcpy(dst, str.data(), str.size());
+                dst[str.size()] = '\0';
+                return dst;
+            }
+        }
+        char* dst = cursor;
+        std::memcpy(dst, str.data(), str.size());
+        dst[str.size()] = '\0';
+        cursor += needed;
+        remaining -= needed;
+        return dst;
+    }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cursor = nullptr;
+    std::size_t remaining = 0;
+};
+
+} // namespace detail
+
+/**
+ * @brief Thread-safe string interner. Every distinct string gets a dense 32-bit symbol, starting at 0,
+ *        so equality of interned strings becomes integer equality.
+ *        String bytes are stored once in append-only arenas, looking up the string of a symbol is O(1) and lock-free.
+ *        Interning is sharded by hash, each shard has its own lock, arena and hash index. The index keys point into the arena,
+ *        so every string is stored exactly once.
+ */
+class symbol_table {
+public:
+    static constexpr std::size_t shard_count = 16;
+
+    symbol_table() = default;
+
+    symbol_table(symbol_table const&) = delete;
+    symbol_table& operator=(symbol_table const&) = delete;
+
+    ~symbol_table() {
+        for (auto& segment : segments) {
+            delete[] segment.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Intern a string. Safe to call from multiple threads.
+     * @param str String to intern.
+     * @return The symbol of the string. Interning the same string again returns the same symbol.
+     */
+    std::uint32_t intern(std::string_view str) {
+        shard& s = shard_for(str);
+        {
+            std::shared_lock lock(s.mutex);
+            std::uint32_t const existing = s.find(str);
+            if (existing != invalid_symbol) return existing;
+        }
+
+        std::unique_lock lock(s.mutex);
+        // Another thread may have interned it between dropping the shared lock and taking the exclusive one.
+        std::uint32_t const existing = s.find(str);
+        if (existing != invalid_symbol) return existing;
+
+        char const* data = s.arena.append(str);
+        std::uint32_t const id = next_id.fetch_add(1, std::memory_order_relaxed);
+        entry_for(id) = entry { data, static_cast<std::uint32_t>(str.size()) };
+        s.index.emplace(std::string_view(data, str.size()), id);
+        return id;
+    }
+
+    /**
+     * @brief Look up the symbol of a string without interning it. Safe to call from multiple threads.
+     * @return The symbol, or invalid_symbol if the string was never interned.
+     */
+    std::uint32_t find(std::string_view str) const {
+        shard const& s = shard_for(str);
+        std::shared_lock lock(s.mutex);
+        return s.find(str);
+    }
+
+    /**
+     * @brief Get the string of a symbol. The symbol must have been returned by intern().
+     * @return View of the interned string, valid as long as the table is alive. The string is null-terminated.
+     */
+    std::string_view name(std::uint32_t symbol) const {
+        entry const& e = entry_for(symbol);
+        return std::string_view(e.data, e.size);
+    }
+
+    /**
+     * @brief Get the string of a symbol as a null-terminated C string. Can be stored in a plib::value with value::interned_string().
+     */
+    char const* c_str(std::uint32_t symbol) const {
+        return entry_for(symbol).data;
+    }
+
+    /**
+     * @brief Amount of symbols handed out so far.
+     */
+    std::size_t size() const {
+        return next_id.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct entry {
+        char const* data = nullptr;
+        std::uint32_t size = 0;
+    };
+
+    struct shard {
+        mutable std::shared_mutex mutex;
+        detail::string_arena arena;
+        std::unordered_map<std::string_view, std::uint32_t> index;
+
+        std::uint32_t find(std::string_view str) const {
+            auto it = index.find(str);
+            return it != index.end() ? it->second : invalid_symbol;
+        }
+    };
+
+    // Symbol to string table, stored as segments of doubling size so it can grow without moving entries
+    // that other threads may be reading. Segment k holds first_segment_size << k entries.
+    static constexpr std::size_t first_segment_size = 1024;
+    static constexpr std::size_t max_segments = 32;
+
+    std::array<shard, shard_count> shards;
+    std::array<std::atomic<entry*>, max_segments> segments {};
+    std::atomic<std::uint32_t> next_id = 0;
+
+    shard& shard_for(std::string_view str) {
+        return shards[std::hash<std::string_view> {}(str) % shard_count];
+    }
+
+    shard const& shard_for(std::string_view str) const {
+        return shards[std::hash<std::string_view> {}(str) % shard_count];
+    }
+
+    static std::size_t segment_index(std::uint32_t id) {
+        return static_cast<std::size_t>(std::bit_width(id / first_segment_size + 1) - 1);
+    }
+
+    static std::size_t segment_offset(std::uint32_t id, std::size_t segment) {
+        return id - first_segment_size * ((std::size_t(1) << segment) - 1);
+    }
+
+    entry& entry_for(std::uint32_t id) {
+        std::size_t const segment = segment_index(id);
+        entry* data = segments[segment].load(std::memory_order_acquire);
+        if (!data) {
+            // Segments are allocated on demand, if two threads race the loser frees its copy.
+            entry* fresh = new entry[first_segment_size << segment];
+            if (segments[segment].compare_exchange_strong(data, fresh, std::memory_order_acq_rel)) data = fresh;
+            else delete[] fresh;
+        }
+        return data[segment_offset(id, segment)];
+    }
+
+    entry const& entry_for(std::uint32_t id) const {
+        std::size_t const segment = segment_index(id);
+        return segments[segment].load(std::memory_order_acquire)[segment_offset(id, segment)];
+    }
+};
+
+}
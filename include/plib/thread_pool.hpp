@@ -0,0 +1,566 @@
+#pragma once
+
+#include <plib/erased_function.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace plib {
+
+class thread_pool;
+
+namespace detail {
+
+/**
+ * @brief Base of every task in the pool. Tasks are reference counted intrusively so a task and the state its
+ *        handle waits on share a single allocation. The pool holds one reference until the task has run.
+ */
+class task_base {
+public:
+    virtual ~task_base() = default;
+
+    virtual void execute() = 0;
+
+    void acquire() {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+
+private:
+    std::atomic<std::uint32_t> refs = 1;
+};
+
+/**
+ * @brief Completion state of a task with result type R.
+ */
+template<typename R>
+class task_state : public task_base {
+public:
+    bool ready() const {
+        return done.load(std::memory_order_acquire);
+    }
+
+    std::atomic<bool> done = false;
+    std::optional<std::conditional_t<std::is_void_v<R>, bool, R>> result;
+    std::exception_ptr error;
+
+protected:
+    void finish() {
+        done.store(true, std::memory_order_release);
+        done.notify_all();
+    }
+};
+
+template<typename R, typename F>
+class task_impl final : public task_state<R> {
+public:
+    explicit task_impl(F&& f) : function(std::move(f)) {}
+
+    void execute() override {
+        try {
+            if constexpr (std::is_void_v<R>) {
+                function();
+                this->result.emplace(true);
+            } else {
+                this->result.emplace(function());
+            }
+        } catch (...) {
+            this->error = std::current_exception();
+        }
+        this->finish();
+    }
+
+private:
+    F function;
+};
+
+/**
+ * @brief Chase-Lev work-stealing deque (Lê, Pop, Cohen, Zappa Nardelli: "Correct and Efficient Work-Stealing for Weak Memory Models").
+ *        The owning thread pushes and pops at the bottom, any other thread steals from the top.
+ *        When the ring buffer is full it is doubled, old buffers are kept alive until the deque is destroyed since
+ *        a concurrent thief may still be reading from them.
+ */
+template<typename T>
+class chase_lev_deque {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "chase_lev_deque only stores trivially copyable values");
+
+    explicit chase_lev_deque(std::size_t capacity = 256) {
+        buffers.push_back(std::make_unique<ring>(std::max<std::size_t>(next_capacity(capacity), 2)));
+        array.store(buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    chase_lev_deque(chase_lev_deque const&) = delete;
+    chase_lev_deque& operator=(chase_lev_deque const&) = delete;
+
+    // Owner only.
+    void push(T value) {
+        std::int64_t const b = bottom.load(std::memory_order_relaxed);
+        std::int64_t const t = top.load(std::memory_order_acquire);
+        ring* a = array.load(std::memory_order_relaxed);
+        if (b - t > static_cast<std::int64_t>(a->capacity) - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only.
+    std::optional<T> pop() {
+        std::int64_t const b = bottom.load(std::memory_order_relaxed) - 1;
+        ring* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        std::optional<T> value = a->get(b);
+        if (t == b) {
+            // Last element, race against thieves for it.
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                value = std::nullopt;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+    // Any thread. Returns std::nullopt if the deque is empty or the steal lost a race.
+    std::optional<T> steal() {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t const b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return std::nullopt;
+
+        ring* a = array.load(std::memory_order_acquire);
+        T value = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    bool empty() const {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct ring {
+        explicit ring(std::size_t capacity) : capacity(capacity), mask(capacity - 1), items(new std::atomic<T>[capacity]) {}
+
+        T get(std::int64_t i) const {
+            return items[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, T value) {
+            items[static_cast<std::size_t>(i) & mask].store(value, std::memory_order_relaxed);
+        }
+
+        std::size_t capacity;
+        std::size_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    alignas(64) std::atomic<std::int64_t> top = 0;
+    alignas(64) std::atomic<std::int64_t> bottom = 0;
+    alignas(64) std::atomic<ring*> array = nullptr;
+    // Only touched by the owner.
+    std::vector<std::unique_ptr<ring>> buffers;
+
+    static std::size_t next_capacity(std::size_t v) {
+        std::size_t capacity = 1;
+        while (capacity < v) capacity <<= 1;
+        return capacity;
+    }
+
+    ring* grow(ring* old, std::int64_t t, std::int64_t b) {
+        buffers.push_back(std::make_unique<ring>(old->capacity * 2));
+        ring* bigger = buffers.back().get();
+        for (std::int64_t i = t; i < b; ++i) bigger->put(i, old->get(i));
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+};
+
+/**
+ * @brief State shared by the chunks of one parallel_for call. Lives on the heap so it outlives the call if needed.
+ */
+template<typename F>
+struct parallel_for_state {
+    parallel_for_state(F& body, std::size_t begin, std::size_t end, std::size_t grain, std::size_t chunks)
+        : body(body), begin(begin), end(end), grain(grain), remaining(chunks) {}
+
+    void run_chunk(std::size_t chunk) {
+        std::size_t const first = begin + chunk * grain;
+        std::size_t const last = std::min(end, first + grain);
+        try {
+            for (std::size_t i = first; i < last; ++i) body(i);
+        } catch (...) {
+            if (!failed.exchange(true)) error = std::current_exception();
+        }
+        // body may be gone once the counter reaches zero, only the state itself can be touched after this.
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) remaining.notify_all();
+    }
+
+    F& body;
+    std::size_t begin;
+    std::size_t end;
+    std::size_t grain;
+    std::atomic<std::size_t> remaining;
+    std::atomic<bool> failed = false;
+    std::exception_ptr error;
+};
+
+// Identifies the pool and deque owned by the current thread.
+struct worker_info {
+    thread_pool const* pool = nullptr;
+    std::size_t index = 0;
+};
+
+} // namespace detail
+
+/**
+ * @brief Handle to the result of a task submitted to a thread_pool. Cheap to move, the task and its result share one allocation.
+ * @tparam R Result type of the task.
+ */
+template<typename R>
+class task_handle {
+public:
+    task_handle() = default;
+
+    task_handle(task_handle const&) = delete;
+    task_handle& operator=(task_handle const&) = delete;
+
+    task_handle(task_handle&& rhs) noexcept : state(std::exchange(rhs.state, nullptr)), pool(rhs.pool) {}
+
+    task_handle& operator=(task_handle&& rhs) noexcept {
+        if (this != &rhs) {
+            if (state) state->release();
+            state = std::exchange(rhs.state, nullptr);
+            pool = rhs.pool;
+        }
+        return *this;
+    }
+
+    ~task_handle() {
+        if (state) state->release();
+    }
+
+    bool valid() const {
+        return state != nullptr;
+    }
+
+    bool ready() const {
+        return state->ready();
+    }
+
+    /**
+     * @brief Wait until the task has finished. A waiting worker thread keeps executing other tasks in the meantime.
+     */
+    void wait() const;
+
+    /**
+     * @brief Wait for the task and return its result. Rethrows any exception thrown by the task.
+     *        Can only be called once, the result is moved out.
+     */
+    R get() {
+        wait();
+        if (state->error) std::rethrow_exception(state->error);
+        if constexpr (!std::is_void_v<R>) {
+            return std::move(*state->result);
+        }
+    }
+
+private:
+    friend class thread_pool;
+
+    task_handle(detail::task_state<R>* state, thread_pool* pool) : state(state), pool(pool) {}
+
+    detail::task_state<R>* state = nullptr;
+    thread_pool* pool = nullptr;
+};
+
+/**
+ * @brief Work-stealing thread pool. Every worker owns a Chase-Lev deque it pushes to and pops from, idle workers steal
+ *        from the others. Tasks submitted from outside the pool go through a shared injection queue.
+ */
+class thread_pool {
+public:
+    /**
+     * @brief Start the pool.
+     * @param thread_count Amount of worker threads. Defaults to the amount of hardware threads.
+     */
+    explicit thread_pool(std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency())) {
+        thread_count = std::max<std::size_t>(thread_count, 1);
+        queues.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; ++i) {
+            queues.push_back(std::make_unique<detail::chase_lev_deque<detail::task_base*>>());
+        }
+        workers.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; ++i) {
+            workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    /**
+     * @brief Finishes all queued tasks, then stops and joins the worker threads.
+     */
+    ~thread_pool() {
+        {
+            std::lock_guard lock(sleep_mutex);
+            stopping.store(true, std::memory_order_seq_cst);
+        }
+        sleep_cv.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    std::size_t size() const {
+        return workers.size();
+    }
+
+    /**
+     * @brief Queue a callable for execution.
+     * @return Handle to wait on and retrieve the result of the callable.
+     */
+    template<typename F> requires std::invocable<std::decay_t<F>&>
+    auto submit(F&& f) {
+        using result_type = std::invoke_result_t<std::decay_t<F>&>;
+        auto* task = new detail::task_impl<result_type, std::decay_t<F>>(std::forward<F>(f));
+        // One reference for the handle, one for the queue.
+        task->acquire();
+        push(task);
+        return task_handle<result_type>(task, this);
+    }
+
+    /**
+     * @brief Queue a call to a type-erased function. The arguments are copied into the task.
+     *        The function must stay alive until the task has finished.
+     * @return Handle to the return value of the function.
+     */
+    template<typename V, typename... Ts> requires (std::convertible_to<Ts, V> && ...)
+    task_handle<V> submit(erased_function<V>& function, Ts&&... args) {
+        return submit([&function, values = std::array<V, sizeof...(Ts)> { V(std::forward<Ts>(args))... }]() {
+            V result {};
+            function.call(std::span<V const>(values), &result);
+            return result;
+        });
+    }
+
+    /**
+     * @brief Run body(i) for every i in [begin, end), split into chunks of grain indices that are spread over the workers.
+     *        The calling thread helps executing chunks and returns once all of them have finished.
+     *        If any call throws, the first exception is rethrown after all chunks are done.
+     * @param grain Amount of indices per task. 0 picks a grain that gives every worker a few chunks.
+     */
+    template<typename F>
+    void parallel_for(std::size_t begin, std::size_t end, F&& body, std::size_t grain = 0) {
+        if (begin >= end) return;
+        std::size_t const count = end - begin;
+        if (grain == 0) grain = std::max<std::size_t>(1, count / (size() * 4));
+        std::size_t const chunks = (count + grain - 1) / grain;
+
+        using state_type = detail::parallel_for_state<std::remove_reference_t<F>>;
+        auto state = std::make_shared<state_type>(body, begin, end, grain, chunks);
+
+        // The first chunk is run inline, the rest is queued. Every task shares ownership of the state, since the last chunk
+        // still notifies it after the counter reached zero, at which point this call may already have returned.
+        std::vector<detail::task_base*> tasks;
+        tasks.reserve(chunks - 1);
+        for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+            auto f = [state, chunk] { state->run_chunk(chunk); };
+            tasks.push_back(new detail::task_impl<void, decltype(f)>(std::move(f)));
+        }
+        push_bulk(tasks);
+        state->run_chunk(0);
+
+        wait_until([&] { return state->remaining.load(std::memory_order_acquire) == 0; }, [&] {
+            std::size_t left = state->remaining.load(std::memory_order_acquire);
+            if (left != 0) state->remaining.wait(left, std::memory_order_acquire);
+        });
+
+        if (state->error) std::rethrow_exception(state->error);
+    }
+
+    /**
+     * @brief Try to execute one queued task on the calling thread.
+     * @return True if a task was executed.
+     */
+    bool run_one() {
+        detail::task_base* task = find_task(current_worker_index());
+        if (!task) return false;
+        run(task);
+        return true;
+    }
+
+private:
+    template<typename R>
+    friend class task_handle;
+
+    std::vector<std::unique_ptr<detail::chase_lev_deque<detail::task_base*>>> queues;
+    std::vector<std::thread> workers;
+
+    // Tasks submitted from threads that are not workers of this pool.
+    std::mutex injection_mutex;
+    std::deque<detail::task_base*> injection;
+    // Size of injection, written under injection_mutex. Lets find_task skip the mutex while the queue is empty so idle
+    // workers spinning for work do not serialize on it.
+    std::atomic<std::size_t> injected = 0;
+
+    // Amount of tasks that are queued and not yet taken by any thread. Idle workers sleep while this is zero.
+    std::atomic<std::size_t> queued = 0;
+    std::atomic<std::size_t> sleeping = 0;
+    std::atomic<bool> stopping = false;
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+
+    static inline thread_local detail::worker_info current_worker {};
+
+    static constexpr std::size_t no_worker = static_cast<std::size_t>(-1);
+    static constexpr int spin_count = 64;
+
+    std::size_t current_worker_index() const {
+        return current_worker.pool == this ? current_worker.index : no_worker;
+    }
+
+    // The counter is raised before the task is published, otherwise a thread taking it could decrement first and wrap around.
+    void push(detail::task_base* task) {
+        queued.fetch_add(1, std::memory_order_seq_cst);
+        std::size_t const worker = current_worker_index();
+        if (worker != no_worker) {
+            queues[worker]->push(task);
+        } else {
+            std::lock_guard lock(injection_mutex);
+            injection.push_back(task);
+            injected.store(injection.size(), std::memory_order_relaxed);
+        }
+        wake(1);
+    }
+
+    void push_bulk(std::span<detail::task_base* const> tasks) {
+        if (tasks.empty()) return;
+        queued.fetch_add(tasks.size(), std::memory_order_seq_cst);
+        std::size_t const worker = current_worker_index();
+        if (worker != no_worker) {
+            for (detail::task_base* task : tasks) queues[worker]->push(task);
+        } else {
+            std::lock_guard lock(injection_mutex);
+            injection.insert(injection.end(), tasks.begin(), tasks.end());
+            injected.store(injection.size(), std::memory_order_relaxed);
+        }
+        wake(tasks.size());
+    }
+
+    void wake(std::size_t count) {
+        if (sleeping.load(std::memory_order_seq_cst) == 0) return;
+        // Taking the lock orders this notify after a worker that saw queued == 0 has started waiting.
+        { std::lock_guard lock(sleep_mutex); }
+        if (count == 1) sleep_cv.notify_one();
+        else sleep_cv.notify_all();
+    }
+
+    detail::task_base* find_task(std::size_t self) {
+        detail::task_base* task = nullptr;
+        if (self != no_worker) {
+            if (auto own = queues[self]->pop()) task = *own;
+        }
+        // A stale zero only delays taking the task, queued stays non-zero so the caller keeps looking instead of sleeping.
+        if (!task && injected.load(std::memory_order_relaxed) != 0) {
+            std::lock_guard lock(injection_mutex);
+            if (!injection.empty()) {
+                task = injection.front();
+                injection.pop_front();
+                injected.store(injection.size(), std::memory_order_relaxed);
+            }
+        }
+        if (!task) {
+            // Steal, starting at the next worker so thieves spread out over the victims.
+            std::size_t const n = queues.size();
+            std::size_t const start = self == no_worker ? 0 : self + 1;
+            for (std::size_t i = 0; i < n && !task; ++i) {
+                std::size_t const victim = (start + i) % n;
+                if (victim == self) continue;
+                if (auto stolen = queues[victim]->steal()) task = *stolen;
+            }
+        }
+        if (task) queued.fetch_sub(1, std::memory_order_seq_cst);
+        return task;
+    }
+
+    void run(detail::task_base* task) {
+        task->execute();
+        task->release();
+    }
+
+    void worker_loop(std::size_t index) {
+        current_worker = { this, index };
+        while (true) {
+            detail::task_base* task = nullptr;
+            for (int spin = 0; spin < spin_count && !task; ++spin) {
+                task = find_task(index);
+                if (!task) std::this_thread::yield();
+            }
+            if (task) {
+                run(task);
+                continue;
+            }
+
+            std::unique_lock lock(sleep_mutex);
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            sleep_cv.wait(lock, [this] {
+                return queued.load(std::memory_order_seq_cst) != 0 || stopping.load(std::memory_order_seq_cst);
+            });
+            sleeping.fetch_sub(1, std::memory_order_seq_cst);
+            if (stopping.load() && queued.load() == 0) return;
+        }
+    }
+
+    // Wait until done() returns true. Workers keep running other tasks while waiting so nested waits cannot deadlock the pool,
+    // other threads help while there is work and block() otherwise.
+    template<typename Done, typename Block>
+    void wait_until(Done&& done, Block&& block) {
+        std::size_t const self = current_worker_index();
+        while (!done()) {
+            if (detail::task_base* task = find_task(self)) {
+                run(task);
+            } else if (self != no_worker) {
+                std::this_thread::yield();
+            } else {
+                block();
+            }
+        }
+    }
+};
+
+template<typename R>
+void task_handle<R>::wait() const {
+    if (state->ready()) return;
+    pool->wait_until([this] { return state->ready(); }, [this] { state->done.wait(false, std::memory_order_acquire); });
+}
+
+}
@@ -2,6 +2,8 @@
 
 #include <plib/types.hpp>
 
+#include <type_traits>
+
 namespace plib {
 
 namespace detail {
@@ -81,4 +83,81 @@ struct make_pack {
 };
 
 
+/**
+ * @brief Deduces the return type and argument types of a callable. Works for function pointers, member function pointers
+ *        and function objects with a single, non-template operator() (this includes non-generic lambdas).
+ */
+template<typename F>
+struct function_traits : function_traits<decltype(&F::operator())> {};
+
+template<typename R, typename... Args>
+struct function_traits<R(Args...)> {
+    using return_type = R;
+    using argument_types = pack<Args...>;
+    static constexpr size_t arity = sizeof...(Args);
+};
+
+template<typename R, typename... Args>
+struct function_traits<R(Args...) noexcept> : function_traits<R(Args...)> {};
+
+template<typename R, typename... Args>
+struct function_traits<R(*)(Args...)> : function_traits<R(Args...)> {};
+
+template<typename R, typename... Args>
+struct function_traits<R(*)(Args...) noexcept> : function_traits<R(Args...)> {};
+
+template<typename R, typename C, typename... Args>
+struct function_traits<R(C::*)(Args...)> : function_traits<R(Args...)> {
+    using class_type = C;
+};
+
+template<typename R, typename C, typename... Args>
+struct function_traits<R(C::*)(Args...) const> : function_traits<R(Args...)> {
+    using class_type = C const;
+};
+
+template<typename R, typename C, typename... Args>
+struct function_traits<R(C::*)(Args...) noexcept> : function_traits<R(Args...)> {
+    using class_type = C;
+};
+
+template<typename R, typename C, typename... Args>
+struct function_traits<R(C::*)(Args...) const noexcept> : function_traits<R(Args...)> {
+    using class_type = C const;
+};
+
+/**
+ * @brief Range of enumerator values of an enum that is used as a dense index, for enum_set and enum_map.
+ *        By default the enum must have a count enumerator after its last value, with values starting at 0:
+ *        enum class color { red, green, blue, count };
+ *        Specialize this for enums that do not follow that pattern.
+ */
+template<typename E>
+struct enum_range {
+    static constexpr underlying_type_t<E> min = 0;
+    static constexpr underlying_type_t<E> max = static_cast<underlying_type_t<E>>(E::count) - 1;
+};
+
+/**
+ * @brief Amount of enumerators in enum_range<E>.
+ */
+template<typename E>
+inline constexpr size_t enum_size_v = static_cast<size_t>(enum_range<E>::max - enum_range<E>::min) + 1;
+
+/**
+ * @brief Dense index of an enumerator, in [0, enum_size_v<E>).
+ */
+template<typename E>
+constexpr size_t enum_index(E e) {
+    return static_cast<size_t>(static_cast<underlying_type_t<E>>(e) - enum_range<E>::min);
+}
+
+/**
+ * @brief Enumerator with a given dense index.
+ */
+template<typename E>
+constexpr E enum_from_index(size_t index) {
+    return static_cast<E>(static_cast<underlying_type_t<E>>(index) + enum_range<E>::min);
+}
+
 }
\ No newline at end of file
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <memory_resource>
 #include <optional>
+#include <utility>
 #include <vector>
 
+#include <plib/macros.hpp>
+#if defined(PLIB_ENABLE_PROFILE)
+#include <plib/profile.hpp>
+#endif
 
 namespace plib {
 
@@ -53,15 +62,46 @@ public:
 	 * @brief Construct a trie with a given alphabet.
 	 * @param alpha Alphabet for the trie. This can help the implementation choose a more efficient representation.
 	 *		  The default alphabet includes the whole character range.
+	 * @param resource Memory resource the nodes are allocated from, such as a plib::monotonic_arena or a plib::pool_resource
+	 *		  with blocks of node_size(). Must outlive the trie.
 	*/
-	trie(alphabet alpha = {}) : alpha(alpha) {
+	trie(alphabet alpha = {}, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : alpha(alpha), resource(resource) {
 		alphabet_size = static_cast<std::int64_t>(alpha.max) - static_cast<std::int64_t>(alpha.min) + 1;
+		create_roots();
+	}
 
-		root_node.resize(alphabet_size);
-		for (std::uint32_t i = 0; i < alphabet_size; ++i) {
-			root_node[i] = std::make_unique<ternary_node>();
-			root_node[i]->key = static_cast<character_type>(static_cast<std::uint32_t>(alpha.min) + i);
+	trie(trie const&) = delete;
+	trie& operator=(trie const&) = delete;
+
+	/**
+	 * @brief Take over the nodes of rhs. rhs is left empty and can still be used, which allocates new root nodes for it.
+	*/
+	trie(trie&& rhs)
+		: alpha(rhs.alpha), alphabet_size(rhs.alphabet_size), root_node(std::exchange(rhs.root_node, {})), resource(rhs.resource) {
+		rhs.create_roots();
+	}
+
+	trie& operator=(trie&& rhs) {
+		if (this != &rhs) {
+			destroy_nodes();
+			alpha = rhs.alpha;
+			alphabet_size = rhs.alphabet_size;
+			root_node = std::exchange(rhs.root_node, {});
+			resource = rhs.resource;
+			rhs.create_roots();
 		}
+		return *this;
+	}
+
+	~trie() {
+		destroy_nodes();
+	}
+
+	/**
+	 * @brief Size in bytes of a single node, every node is a separate allocation of this size.
+	*/
+	static constexpr std::size_t node_size() {
+		return sizeof(ternary_node);
 	}
 
 	/**
@@ -85,6 +125,7 @@ public:
 	 * @param str The string to insert. An empty string will be ignored.
 	*/
 	void insert(S const& str, V&& value) {
+		PLIB_PROFILE_ZONE("trie::insert");
 		if (str.size() == 0) return;
 
 		// Get the first character so we can index into our TST.
@@ -93,7 +134,7 @@ public:
 		// Note that we always insert in middle from the root node, since the character matches.
 		// We also make sure to only call this insert when the length of the string is > 1.
 		if (str.size() > 1) {
-			root->middle = tst_insert(root->middle, str, std::move(value), 1);
+			tst_insert(root->middle, str, std::move(value), 1);
 		}
 		else {
 			// This key only has a single character, mark the key as an entry.
@@ -108,6 +149,7 @@ public:
 	 * @return An optional containing the value, or std::nullopt if the key was not found.
 	*/
 	std::optional<value_type> get(S const& str) const {
+		PLIB_PROFILE_ZONE("trie::get");
 		if (str.size() == 0) return std::nullopt;
 
 		character_type first = str[0];
@@ -133,32 +175,29 @@ public:
 
 
 	std::vector<S> collect_with_prefix(S const& prefix) const {
+		PLIB_PROFILE_ZONE("trie::collect_with_prefix");
 		std::vector<S> result;
 		if (prefix.size() == 0) {
 			// No prefix, instead we will collect with every character as a singular prefix.
 			// This is necessary because of how our hybrid TST is implemented.
-			for (character_type c = alpha.min; c <= alpha.max; ++c) {
-				S new_prefix;
-				new_prefix.push_back(c);
-
-				auto const& root = root_node[char_index(c)];
-				tst_collect(root, "", new_prefix, result);
+			// Loop over indices, c <= alpha.max would always hold when max is the largest character.
+			S buffer;
+			for (std::uint32_t i = 0; i < alphabet_size; ++i) {
+				tst_collect(root_node[i], buffer, result);
 			}
 		}
 		else if (prefix.size() == 1) {
-			character_type c = prefix[0];
-			S new_prefix;
-			new_prefix.push_back(c);
-
-			auto const& root = root_node[char_index(c)];
-			tst_collect(root, "", new_prefix, result);
+			S buffer;
+			tst_collect(root_node[char_index(prefix[0])], buffer, result);
 		}
 		else {
 			character_type c = prefix[0];
 			auto const& root = root_node[char_index(c)];
 			auto const& node = tst_get(root, prefix, 0);
+			if (!node) return result;
 			if (node->middle) {
-				tst_collect(node->middle, prefix, prefix + node->middle->key, result);
+				S buffer = prefix;
+				tst_collect(node->middle, buffer, result);
 			}
 			// This node could also be a value, add it.
 			if (node->value) {
@@ -177,6 +216,83 @@ public:
 		return collect_with_prefix(S{});
 	}
 
+	/**
+	 * @brief A single result of a prefix query.
+	*/
+	struct prefix_match {
+		/**
+		 * @brief Length of the matched key. The key itself is the first length characters of the searched text.
+		*/
+		std::size_t length = 0;
+
+		/**
+		 * @brief Pointer to the value associated with the key.
+		*/
+		value_type const* value = nullptr;
+	};
+
+	/**
+	 * @brief Find every stored key that is a prefix of a given text. The text is walked only once.
+	 * @param text The text to match against.
+	 * @return A vector with a prefix_match for every stored key that is a prefix of text, ordered from shortest to longest.
+	*/
+	std::vector<prefix_match> prefixes_of(S const& text) const {
+		PLIB_PROFILE_ZONE("trie::prefixes_of");
+		std::vector<prefix_match> result;
+		walk_prefixes(text, [&result](std::size_t length, value_type const& value) {
+			result.push_back({ length, &value });
+		});
+		return result;
+	}
+
+	/**
+	 * @brief Find the longest stored key that is a prefix of a given text. Useful for routing tables and tokenizers.
+	 * @param text The text to match against.
+	 * @return The longest matching key, or std::nullopt if no stored key is a prefix of text.
+	*/
+	std::optional<prefix_match> longest_prefix_of(S const& text) const {
+		PLIB_PROFILE_ZONE("trie::longest_prefix_of");
+		std::optional<prefix_match> result = std::nullopt;
+		walk_prefixes(text, [&result](std::size_t length, value_type const& value) {
+			result = prefix_match{ length, &value };
+		});
+		return result;
+	}
+
+	/**
+	 * @brief A single result of an approximate search.
+	*/
+	struct fuzzy_match {
+		/**
+		 * @brief The stored key that matched the query.
+		*/
+		key_type key{};
+
+		/**
+		 * @brief Pointer to the value associated with the key. Stays valid as long as the key is not overwritten and the trie is alive.
+		*/
+		value_type const* value = nullptr;
+
+		/**
+		 * @brief Levenshtein distance between the query and the key.
+		*/
+		std::size_t distance = 0;
+	};
+
+	class fuzzy_range;
+
+	/**
+	 * @brief Find all keys within a given edit distance of a query string.
+	 *		  The trie is walked depth-first while keeping one Levenshtein DP row per depth, and subtrees are pruned
+	 *		  as soon as every entry in their row exceeds max_distance.
+	 * @param query The string to search for.
+	 * @param max_distance Maximum Levenshtein distance (insertions, deletions and substitutions) of a match.
+	 * @return A lazy range of fuzzy_match objects. Matches are produced while iterating, the trie must outlive the range.
+	*/
+	fuzzy_range fuzzy_search(S const& query, std::size_t max_distance) const {
+		return fuzzy_range(this, query, max_distance);
+	}
+
 private:
 	/**
 	 * @brief Node in the TST.
@@ -195,66 +311,296 @@ private:
 		/**
 		 * @brief TST with key < this.key
 		*/
-		std::unique_ptr<ternary_node> left;
+		ternary_node* left = nullptr;
 		/**
 		 * @brief TST with key == this.key
 		*/
-		std::unique_ptr<ternary_node> middle;
+		ternary_node* middle = nullptr;
 		/**
 		 * @brief TST with key > this.key
 		*/
-		std::unique_ptr<ternary_node> right;
+		ternary_node* right = nullptr;
 	};
 
 	alphabet alpha;
 	std::uint32_t alphabet_size = 0;
 
-	std::vector<std::unique_ptr<ternary_node>> root_node{};
+	std::vector<ternary_node*> root_node{};
+
+	std::pmr::memory_resource* resource = nullptr;
+
+	ternary_node* create_node(character_type key) {
+		ternary_node* node = new (resource->allocate(sizeof(ternary_node), alignof(ternary_node))) ternary_node();
+		node->key = key;
+		return node;
+	}
+
+	void create_roots() {
+		root_node.resize(alphabet_size);
+		for (std::uint32_t i = 0; i < alphabet_size; ++i) {
+			root_node[i] = create_node(static_cast<character_type>(static_cast<std::uint32_t>(alpha.min) + i));
+		}
+	}
+
+	// Nodes are destroyed with an explicit stack, recursing would overflow the call stack on long keys.
+	void destroy_nodes() {
+		std::vector<ternary_node*> stack(root_node.begin(), root_node.end());
+		while (!stack.empty()) {
+			ternary_node* node = stack.back();
+			stack.pop_back();
+			if (!node) continue;
+			stack.push_back(node->left);
+			stack.push_back(node->middle);
+			stack.push_back(node->right);
+			node->~ternary_node();
+			resource->deallocate(node, sizeof(ternary_node), alignof(ternary_node));
+		}
+		root_node.clear();
+	}
 
 	std::uint32_t char_index(character_type c) const {
 		return static_cast<std::uint32_t>(c) - static_cast<std::uint32_t>(alpha.min);
 	}
 
-	std::unique_ptr<ternary_node> tst_insert(std::unique_ptr<ternary_node>& node, S const& str, value_type&& value, std::size_t index) {
-		character_type c = str[index];
+	// Walks down by following links instead of recursing, so long keys cannot overflow the call stack.
+	void tst_insert(ternary_node*& node, S const& str, value_type&& value, std::size_t index) {
+		ternary_node** link = &node;
+		while (true) {
+			character_type c = str[index];
 
-		// Node wasn't created yet.
-		if (node == nullptr) {
-			node = std::make_unique<ternary_node>();
-			node->key = c;
+			// Node wasn't created yet.
+			if (*link == nullptr) {
+				*link = create_node(c);
+			}
+
+			// Continue in the correct sub-trie
+			ternary_node* current = *link;
+			if (c < current->key) link = &current->left;
+			else if (c > current->key) link = &current->right;
+			else if (index < str.size() - 1) {
+				link = &current->middle;
+				++index;
+			}
+			else {
+				current->value = std::move(value);
+				return;
+			}
 		}
+	}
 
-		// Insert in the correct sub-trie
-		if (c < node->key) node->left = tst_insert(node->left, str, std::forward<value_type>(value), index);
-		else if (c > node->key) node->right = tst_insert(node->right, str, std::forward<value_type>(value), index);
-		else if (index < str.size() - 1) node->middle = tst_insert(node->middle, str, std::forward<value_type>(value), index + 1);
-		else node->value = std::move(value);
+	// Follow str from index through the TST starting at node. visit(link, i) is called for every node on the path
+	// whose key equals str[i]. The walk stops when visit returns false, the path ends or str is exhausted.
+	template<typename F>
+	void tst_descend(ternary_node* const& node, S const& str, std::size_t index, F&& visit) const {
+		ternary_node* const* link = &node;
+		while (*link != nullptr && index < str.size()) {
+			character_type c = str[index];
+			if (c < (*link)->key) link = &(*link)->left;
+			else if (c > (*link)->key) link = &(*link)->right;
+			else {
+				if (!visit(*link, index)) return;
+				link = &(*link)->middle;
+				++index;
+			}
+		}
+	}
 
-		return std::move(node);
+	ternary_node* const& tst_get(ternary_node* const& node, S const& str, std::size_t index) const {
+		static ternary_node* const el_rubio = nullptr;
+		ternary_node* const* result = &el_rubio;
+		tst_descend(node, str, index, [&](ternary_node* const& link, std::size_t i) {
+			if (i < str.size() - 1) return true;
+			result = &link;
+			return false;
+		});
+		return *result;
 	}
 
-	std::unique_ptr<ternary_node> const& tst_get(std::unique_ptr<ternary_node> const& node, S const& str, std::size_t index) const {
-		static std::unique_ptr<ternary_node> el_rubio;
-		if (node == nullptr) return el_rubio;
+	// Call visit(length, value) for every stored key that is a prefix of text, from shortest to longest.
+	template<typename F>
+	void walk_prefixes(S const& text, F&& visit) const {
+		if (text.size() == 0) return;
+
+		character_type first = text[0];
+		if (first < alpha.min || first > alpha.max) return;
 
-		character_type c = str[index];
-		if (c < node->key) return tst_get(node->left, str, index);
-		else if (c > node->key) return tst_get(node->right, str, index);
-		else if (index < str.size() - 1) return tst_get(node->middle, str, index + 1);
-		else return node;
+		auto const& root = root_node[char_index(first)];
+		if (root->value) visit(1, *root->value);
+		tst_descend(root->middle, text, 1, [&](ternary_node* const& link, std::size_t i) {
+			if (link->value) visit(i + 1, *link->value);
+			return true;
+		});
 	}
 
-	void tst_collect(std::unique_ptr<ternary_node> const& node, S const& prev_prefix, S const& prefix, std::vector<S>& result) const {
-		if (node == nullptr) return;
+	// Collect every key stored in the TST at node. prefix holds the characters leading up to node, it is used as scratch space
+	// and restored before returning.
+	// Uses an explicit stack of (node, depth) and a single buffer, recursing and copying the prefix per character would overflow
+	// the call stack and take quadratic time on long keys.
+	void tst_collect(ternary_node* node, S& prefix, std::vector<S>& result) const {
+		std::size_t const base = prefix.size();
+		std::vector<std::pair<ternary_node*, std::size_t>> stack;
+		stack.emplace_back(node, base);
+		while (!stack.empty()) {
+			auto [current, depth] = stack.back();
+			stack.pop_back();
+			if (current == nullptr) continue;
+
+			prefix.resize(depth);
+			prefix.push_back(current->key);
+			if (current->value) {
+				result.push_back(prefix);
+			}
 
-		if (node->value) {
-			result.push_back(prefix);
+			// The middle child is pushed last so its subtree is finished before a sibling overwrites prefix[depth].
+			stack.emplace_back(current->right, depth);
+			stack.emplace_back(current->left, depth);
+			stack.emplace_back(current->middle, depth + 1);
 		}
-
-		if (node->left) tst_collect(node->left, prefix, prev_prefix + node->left->key, result);
-		if (node->middle) tst_collect(node->middle, prefix, prefix + node->middle->key, result);
-		if (node->right) tst_collect(node->right, prefix, prev_prefix + node->right->key, result);
+		prefix.resize(base);
 	}
+
+public:
+	/**
+	 * @brief Lazy range over the results of fuzzy_search(). Iterating it advances the search.
+	*/
+	class fuzzy_range {
+	public:
+		class iterator {
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = fuzzy_match;
+			using difference_type = std::ptrdiff_t;
+			using pointer = fuzzy_match const*;
+			using reference = fuzzy_match const&;
+
+			iterator() = default;
+
+			reference operator*() const { return range->current; }
+			pointer operator->() const { return &range->current; }
+
+			iterator& operator++() {
+				if (!range->advance()) range = nullptr;
+				return *this;
+			}
+
+			void operator++(int) { ++*this; }
+
+			friend bool operator==(iterator const& lhs, iterator const& rhs) {
+				return lhs.range == rhs.range;
+			}
+
+			friend bool operator!=(iterator const& lhs, iterator const& rhs) {
+				return lhs.range != rhs.range;
+			}
+
+		private:
+			friend class fuzzy_range;
+
+			explicit iterator(fuzzy_range* range) : range(range) {}
+
+			fuzzy_range* range = nullptr;
+		};
+
+		fuzzy_range(trie const* owner, S const& query, std::size_t max_distance)
+			: owner(owner), query(query), max_distance(max_distance) {
+			// Row 0 is the distance from the empty prefix to every prefix of the query.
+			rows.emplace_back(query.size() + 1);
+			for (std::size_t j = 0; j <= query.size(); ++j) rows[0][j] = j;
+		}
+
+		/**
+		 * @brief Start iterating. Since this is an input range, begin() may only be called once.
+		*/
+		iterator begin() {
+			if (!advance()) return end();
+			return iterator(this);
+		}
+
+		iterator end() {
+			return iterator();
+		}
+
+	private:
+		/**
+		 * @brief Pending node in the depth-first walk. The DP row of its parent prefix is rows[depth].
+		*/
+		struct frame {
+			ternary_node const* node = nullptr;
+			std::size_t depth = 0;
+		};
+
+		trie const* owner = nullptr;
+		S query{};
+		std::size_t max_distance = 0;
+
+		std::uint32_t next_root = 0;
+		std::vector<frame> stack{};
+		// rows[d] holds the DP row of the current prefix of length d. Frames are popped in an order
+		// where a frame at depth d only ever overwrites rows[d + 1], so rows shared by siblings stay intact.
+		std::vector<std::vector<std::size_t>> rows{};
+		S prefix{};
+
+		fuzzy_match current{};
+
+		// Advance to the next match. Returns false if there are no more matches.
+		// The search is lazy, so every step is its own zone instead of one zone around fuzzy_search().
+		bool advance() {
+			PLIB_PROFILE_ZONE("trie::fuzzy_search");
+			while (true) {
+				if (stack.empty()) {
+					// Start the walk in the next non-empty root TST.
+					while (next_root < owner->alphabet_size) {
+						ternary_node const* root = owner->root_node[next_root++];
+						if (root->value || root->middle) {
+							stack.push_back({ root, 0 });
+							break;
+						}
+					}
+					if (stack.empty()) return false;
+				}
+
+				frame const f = stack.back();
+				stack.pop_back();
+
+				// Siblings share our parent row, so they are pushed regardless of this node.
+				if (f.node->right) stack.push_back({ f.node->right, f.depth });
+				if (f.node->left) stack.push_back({ f.node->left, f.depth });
+
+				std::size_t const row_min = compute_row(f.depth, f.node->key);
+				prefix.resize(f.depth);
+				prefix.push_back(f.node->key);
+
+				// Pushed last so the whole middle subtree is done before rows[f.depth + 1] is overwritten by a sibling.
+				if (f.node->middle && row_min <= max_distance) {
+					stack.push_back({ f.node->middle, f.depth + 1 });
+				}
+
+				std::size_t const distance = rows[f.depth + 1][query.size()];
+				if (f.node->value && distance <= max_distance) {
+					current.key = prefix;
+					current.value = &*f.node->value;
+					current.distance = distance;
+					return true;
+				}
+			}
+		}
+
+		// Compute rows[depth + 1] from rows[depth] for appending character c. Returns the minimum value in the new row.
+		std::size_t compute_row(std::size_t depth, character_type c) {
+			if (rows.size() <= depth + 1) rows.emplace_back(query.size() + 1);
+
+			std::vector<std::size_t> const& prev = rows[depth];
+			std::vector<std::size_t>& row = rows[depth + 1];
+			row[0] = depth + 1;
+			std::size_t row_min = row[0];
+			for (std::size_t j = 1; j <= query.size(); ++j) {
+				std::size_t const substitute = prev[j - 1] + (query[j - 1] == c ? 0 : 1);
+				row[j] = std::min({ row[j - 1] + 1, prev[j] + 1, substitute });
+				row_min = std::min(row_min, row[j]);
+			}
+			return row_min;
+		}
+	};
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace plib {
+
+/**
+ * @brief Thrown when a value is converted to a type it does not hold.
+ */
+class bad_value_access : public std::exception {
+public:
+    char const* what() const noexcept override {
+        return "plib::value does not hold the requested type";
+    }
+};
+
+/**
+ * @brief Compact dynamically typed value, usable as the V of erased_function.
+ *        Everything is packed into a single trivially copyable 8 byte word using NaN-boxing:
+ *        doubles are stored as-is, and all other types live in the payload of a negative quiet NaN.
+ *        Layout of a boxed value: [ 0xFFF8 | tag (3 bits) ] [ 48 bit payload ].
+ *        Supported types are nil, double, 48-bit signed integers, bool, pointers (48-bit addresses),
+ *        small strings of up to 5 bytes stored inline, and pointers to interned null-terminated strings.
+ *        Small strings are zero padded to the 6 byte payload, so they are always null-terminated as well.
+ */
+class value {
+public:
+    enum class type : std::uint8_t {
+        nil,
+        boolean,
+        integer,
+        pointer,
+        small_string,
+        string,
+        number
+    };
+
+    static constexpr std::int64_t int_min = -(std::int64_t(1) << 47);
+    static constexpr std::int64_t int_max = (std::int64_t(1) << 47) - 1;
+    static constexpr std::size_t small_string_capacity = 5;
+
+    /**
+     * @brief Construct a nil value.
+     */
+    constexpr value() = default;
+
+    constexpr value(std::nullptr_t) {}
+
+    value(double d) {
+        // Every NaN produced by arithmetic is folded into a single positive quiet NaN, so it can never be mistaken for a boxed value.
+        bits = d != d ? canonical_nan : std::bit_cast<std::uint64_t>(d);
+    }
+
+    value(float f) : value(static_cast<double>(f)) {}
+
+    constexpr value(bool b) : bits(box(type::boolean, b ? 1 : 0)) {}
+
+    /**
+     * @brief Store an integer. Values outside of [int_min, int_max] do not fit in the payload and are stored as a double instead.
+     */
+    template<std::integral T> requires (!std::same_as<T, bool>)
+    value(T i) {
+        if constexpr (std::is_signed_v<T>) {
+            if (static_cast<std::int64_t>(i) >= int_min && static_cast<std::int64_t>(i) <= int_max) {
+                bits = box(type::integer, static_cast<std::uint64_t>(static_cast<std::int64_t>(i)) & payload_mask);
+                return;
+            }
+        } else {
+            if (static_cast<std::uint64_t>(i) <= static_cast<std::uint64_t>(int_max)) {
+                bits = box(type::integer, static_cast<std::uint64_t>(i));
+                return;
+            }
+        }
+        *this = value(static_cast<double>(i));
+    }
+
+    /**
+     * @brief Store a pointer. Throws std::invalid_argument if the address does not fit in 48 bits.
+     *        Character pointers are strings, see the char const* constructor.
+     */
+    template<typename T> requires (!std::same_as<std::remove_cv_t<T>, char>)
+    value(T* ptr) {
+        auto const address = reinterpret_cast<std::uintptr_t>(ptr);
+        if (address & ~payload_mask) throw std::invalid_argument("Pointer does not fit in a plib::value");
+        bits = box(type::pointer, address);
+    }
+
+    /**
+     * @brief Store a small string inline. Throws std::length_error if the string is longer than small_string_capacity,
+     *        longer strings have to be interned and stored with interned_string().
+     *        Like interned strings, small strings cannot contain null characters (std::invalid_argument is thrown).
+     */
+    explicit value(std::string_view str) {
+        if (str.size() > small_string_capacity) throw std::length_error("String too long to store inline in a plib::value, intern it instead");
+        if (str.find('\0') != std::string_view::npos) throw std::invalid_argument("Strings in a plib::value cannot contain null characters");
+        bits = box(type::small_string, 0);
+        std::memcpy(reinterpret_cast<char*>(&bits) + payload_offset, str.data(), str.size());
+    }
+
+    /**
+     * @brief Store a null-terminated string inline, like the std::string_view constructor.
+     *        Not explicit, so value v = "abc" stores a string just like value("abc") does.
+     */
+    value(char const* str) : value(std::string_view(str)) {}
+
+    /**
+     * @brief Store a pointer to an interned, null-terminated string. The string must outlive the value.
+     */
+    static value interned_string(char const* str) {
+        auto const address = reinterpret_cast<std::uintptr_t>(str);
+        if (address & ~payload_mask) throw std::invalid_argument("Pointer does not fit in a plib::value");
+        return from_bits(box(type::string, address));
+    }
+
+    static constexpr value from_bits(std::uint64_t raw) {
+        value v;
+        v.bits = raw;
+        return v;
+    }
+
+    constexpr std::uint64_t raw_bits() const {
+        return bits;
+    }
+
+    constexpr type get_type() const {
+        if (!is_boxed()) return type::number;
+        return static_cast<type>((bits >> 48) & tag_mask);
+    }
+
+    constexpr bool is_nil() const { return bits == box(type::nil, 0); }
+    constexpr bool is_number() const { return !is_boxed(); }
+    constexpr bool is_int() const { return is_tag(type::integer); }
+    constexpr bool is_bool() const { return is_tag(type::boolean); }
+    constexpr bool is_pointer() const { return is_tag(type::pointer); }
+    constexpr bool is_string() const { return is_tag(type::small_string) || is_tag(type::string); }
+
+    // Conversions. These are what detail::call_func uses to unpack arguments with static_cast.
+
+    /**
+     * @brief Convert to an arithmetic type. Both integers and doubles convert to any arithmetic type.
+     *        Throws bad_value_access if the value does not fit in an integral T, including NaN and infinities.
+     *        Doubles are truncated towards zero.
+     */
+    template<typename T> requires (std::is_arithmetic_v<T> && !std::same_as<T, bool>)
+    explicit operator T() const {
+        if (is_int()) {
+            std::int64_t const i = as_int();
+            if constexpr (std::is_integral_v<T>) {
+                bool const fits = i < 0 ? std::is_signed_v<T> && i >= static_cast<std::int64_t>(std::numeric_limits<T>::min())
+                                        : static_cast<std::uint64_t>(i) <= static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+                if (!fits) throw bad_value_access();
+            }
+            return static_cast<T>(i);
+        }
+        if (is_number()) {
+            double const d = std::bit_cast<double>(bits);
+            if constexpr (std::is_integral_v<T>) {
+                // Converting a double outside the range of an integer type is undefined behaviour, reject it instead.
+                double const t = std::trunc(d);
+                double const limit = std::ldexp(1.0, std::numeric_limits<T>::digits);
+                double const lower = std::is_signed_v<T> ? -limit : 0.0;
+                if (!(t >= lower && t < limit)) throw bad_value_access();
+            }
+            return static_cast<T>(d);
+        }
+        throw bad_value_access();
+    }
+
+    explicit constexpr operator bool() const {
+        if (!is_bool()) throw bad_value_access();
+        return (bits & 1) != 0;
+    }
+
+    /**
+     * @brief Convert to a pointer. A nil value converts to nullptr. Strings convert to char const*, see c_str().
+     */
+    template<typename T>
+    explicit operator T*() const {
+        if (is_nil()) return nullptr;
+        if constexpr (std::is_same_v<T, char const>) {
+            if (is_string()) return c_str();
+        }
+        if (!is_pointer()) throw bad_value_access();
+        return reinterpret_cast<T*>(static_cast<std::uintptr_t>(bits & payload_mask));
+    }
+
+    /**
+     * @brief View the string held by this value. For small strings the view points into this value,
+     *        so it is only valid as long as this object is.
+     */
+    explicit operator std::string_view() const {
+        if (is_tag(type::small_string)) {
+            char const* str = reinterpret_cast<char const*>(&bits) + payload_offset;
+            std::size_t size = 0;
+            while (size < small_string_capacity && str[size] != '\0') ++size;
+            return std::string_view(str, size);
+        }
+        return std::string_view(c_str());
+    }
+
+    /**
+     * @brief The string held by this value as a null-terminated C string. Like the string_view conversion, small strings
+     *        point into this value.
+     */
+    char const* c_str() const {
+        if (is_tag(type::small_string)) return reinterpret_cast<char const*>(&bits) + payload_offset;
+        if (is_tag(type::string)) return reinterpret_cast<char const*>(static_cast<std::uintptr_t>(bits & payload_mask));
+        throw bad_value_access();
+    }
+
+    explicit operator std::string() const {
+        return std::string(static_cast<std::string_view>(*this));
+    }
+
+    /**
+     * @brief Values are equal if they hold the same type and the same contents. Integers and doubles compare numerically,
+     *        strings compare by contents regardless of whether they are stored inline or interned.
+     */
+    friend bool operator==(value const& lhs, value const& rhs) {
+        if (lhs.is_number() || rhs.is_number()) {
+            if ((lhs.is_number() || lhs.is_int()) && (rhs.is_number() || rhs.is_int())) {
+                return static_cast<double>(lhs) == static_cast<double>(rhs);
+            }
+            return false;
+        }
+        if (lhs.is_string() && rhs.is_string()) {
+            return static_cast<std::string_view>(lhs) == static_cast<std::string_view>(rhs);
+        }
+        return lhs.bits == rhs.bits;
+    }
+
+private:
+    static constexpr std::uint64_t box_prefix = 0xFFF8'0000'0000'0000ull;
+    static constexpr std::uint64_t tag_mask = 0x7;
+    static constexpr std::uint64_t payload_mask = 0x0000'FFFF'FFFF'FFFFull;
+    static constexpr std::uint64_t canonical_nan = 0x7FF8'0000'0000'0000ull;
+    // Byte offset of the payload inside the word, small strings are copied here.
+    static constexpr std::size_t payload_offset = std::endian::native == std::endian::little ? 0 : 2;
+
+    std::uint64_t bits = box(type::nil, 0);
+
+    static constexpr std::uint64_t box(type t, std::uint64_t payload) {
+        return box_prefix | (static_cast<std::uint64_t>(t) << 48) | payload;
+    }
+
+    constexpr bool is_boxed() const {
+        return (bits & box_prefix) == box_prefix;
+    }
+
+    constexpr bool is_tag(type t) const {
+        return (bits & ~payload_mask) == box(t, 0);
+    }
+
+    constexpr std::int64_t as_int() const {
+        // Sign extend the 48 bit payload.
+        return static_cast<std::int64_t>(bits << 16) >> 16;
+    }
+};
+
+static_assert(sizeof(value) == 8, "plib::value must fit in a single word");
+static_assert(std::is_trivially_copyable_v<value>, "plib::value must be trivially copyable");
+
+}
@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/atomic_bit_flag.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum class state : std::uint32_t {
+    none = 0,
+    loaded = 1 << 0,
+    dirty = 1 << 1,
+    locked = 1 << 2,
+    done = 1 << 3
+};
+
+using flags = plib::bit_flag<state>;
+using atomic_flags = plib::atomic_bit_flag<state>;
+
+// Works for both flag types, the atomic one has to offer the same operators.
+template<typename Flag>
+flags combine(Flag const& flag) {
+    flags result = flag | state::dirty;
+    result = result & (state::loaded | flags(state::dirty));
+    result = result ^ flags(state::locked);
+    result = state::done | result;
+    return result & ~flags(state::none);
+}
+
+}
+
+TEST_CASE("atomic_bit_flag matches bit_flag", "[atomic_bit_flag]") {
+    flags const plain(state::loaded);
+    atomic_flags const atomic(state::loaded);
+    CHECK(combine(plain) == combine(atomic));
+    CHECK(combine(atomic) == (state::loaded | flags(state::dirty) | state::locked | state::done));
+
+    CHECK((atomic & state::loaded) == flags(state::loaded));
+    CHECK((state::dirty & atomic) == flags(state::none));
+    CHECK((atomic ^ state::loaded) == flags(state::none));
+    CHECK((flags(state::dirty) ^ atomic) == (state::loaded | flags(state::dirty)));
+    CHECK((atomic | flags(state::done)) == (flags(state::done) | atomic));
+    CHECK(~atomic == ~plain);
+    CHECK(atomic == plain);
+    CHECK(static_cast<bool>(atomic));
+    CHECK_FALSE(!atomic);
+}
+
+TEST_CASE("atomic_bit_flag read-modify-write operations", "[atomic_bit_flag]") {
+    atomic_flags flag;
+    CHECK(!flag);
+    CHECK((flag |= state::loaded) == flags(state::loaded));
+    CHECK((flag |= flags(state::dirty)) == (state::loaded | flags(state::dirty)));
+    CHECK(flag.fetch_and(~flags(state::loaded)) == (state::loaded | flags(state::dirty)));
+    CHECK(flag.load() == flags(state::dirty));
+    CHECK((flag ^= state::dirty) == flags(state::none));
+
+    CHECK_FALSE(flag.test_and_set(state::locked));
+    CHECK(flag.test_and_set(state::locked));
+    CHECK(flag.test(state::locked));
+    CHECK(flag.test_and_reset(state::locked));
+    CHECK_FALSE(flag.test_and_reset(state::locked));
+
+    flags expected(state::none);
+    CHECK(flag.compare_exchange_strong(expected, flags(state::done)));
+    expected = flags(state::loaded);
+    CHECK_FALSE(flag.compare_exchange_strong(expected, flags(state::dirty)));
+    CHECK(expected == flags(state::done));
+    CHECK(flag.exchange(flags(state::none)) == flags(state::done));
+}
+
+TEST_CASE("atomic_bit_flag test_and_set has exactly one winner", "[atomic_bit_flag]") {
+    for (int round = 0; round < 100; ++round) {
+        atomic_flags flag;
+        std::atomic<int> winners = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&] {
+                if (!flag.test_and_set(state::locked)) winners.fetch_add(1);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        REQUIRE(winners.load() == 1);
+    }
+}
+
+TEST_CASE("atomic_bit_flag wakes up waiting threads", "[atomic_bit_flag]") {
+    atomic_flags flag(state::loaded);
+
+    SECTION("wait") {
+        std::thread waiter([&] {
+            flag.wait(flags(state::loaded));
+            CHECK(flag.test(state::dirty));
+        });
+        flag |= state::dirty;
+        flag.notify_all();
+        waiter.join();
+    }
+
+    SECTION("wait_for_set ignores unrelated changes") {
+        std::atomic<bool> woke = false;
+        flags result;
+        std::thread waiter([&] {
+            result = flag.wait_for_set(state::done);
+            woke = true;
+        });
+        // Bits other than the awaited one change first.
+        for (int i = 0; i < 100; ++i) {
+            flag ^= state::dirty;
+            flag.notify_all();
+        }
+        CHECK_FALSE(woke.load());
+        flag |= state::done;
+        flag.notify_all();
+        waiter.join();
+        CHECK(woke.load());
+        CHECK((result & state::done) == flags(state::done));
+        CHECK((result & state::loaded) == flags(state::loaded));
+    }
+}
@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/bits.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+static_assert(plib::pdep(0b101, 0b11010) == 0b10010);
+static_assert(plib::pext(0b10010, 0b11010) == 0b101);
+static_assert(plib::bit_reverse(std::uint8_t(0b0000'0110)) == 0b0110'0000);
+
+// Masks from all-zero to all-one, with every density in between.
+std::vector<std::uint64_t> random_masks(std::mt19937_64& rng) {
+    std::vector<std::uint64_t> masks { 0, ~std::uint64_t(0), 0x5555555555555555ull, 0x8000000000000001ull };
+    for (int i = 0; i < 200; ++i) masks.push_back(rng());
+    for (int i = 0; i < 200; ++i) masks.push_back(rng() & rng() & rng());
+    for (int i = 0; i < 200; ++i) masks.push_back(rng() | rng() | rng());
+    return masks;
+}
+
+}
+
+TEST_CASE("pdep and pext match the portable loops", "[bits]") {
+    std::mt19937_64 rng(7);
+    for (std::uint64_t mask : random_masks(rng)) {
+        for (int i = 0; i < 16; ++i) {
+            std::uint64_t const src = rng();
+            std::uint64_t const expected_dep = plib::detail::pdep_portable(src, mask);
+            std::uint64_t const expected_ext = plib::detail::pext_portable(src, mask);
+            REQUIRE(plib::pdep(src, mask) == expected_dep);
+            REQUIRE(plib::pext(src, mask) == expected_ext);
+            // Depositing and extracting again keeps the low popcount(mask) bits.
+            std::uint64_t const low_bits = std::popcount(mask) == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << std::popcount(mask)) - 1;
+            REQUIRE(plib::pext(expected_dep, mask) == (src & low_bits));
+#if defined(PLIB_BITS_X86)
+            if (plib::cpu_features.bmi2) {
+                REQUIRE(plib::detail::pdep_bmi2(src, mask) == expected_dep);
+                REQUIRE(plib::detail::pext_bmi2(src, mask) == expected_ext);
+            }
+#endif
+        }
+    }
+
+    SECTION("bulk") {
+        std::vector<std::uint64_t> src(37), dep(37), ext(37);
+        for (std::uint64_t& word : src) word = rng();
+        std::uint64_t const mask = rng() & rng();
+        plib::pdep(src, mask, dep);
+        plib::pext(src, mask, ext);
+        for (std::size_t i = 0; i < src.size(); ++i) {
+            CHECK(dep[i] == plib::detail::pdep_portable(src[i], mask));
+            CHECK(ext[i] == plib::detail::pext_portable(src[i], mask));
+        }
+        std::vector<std::uint64_t> too_small(36);
+        CHECK_THROWS_AS(plib::pdep(src, mask, too_small), std::invalid_argument);
+    }
+}
+
+TEST_CASE("bulk kernels match scalar loops", "[bits]") {
+    std::mt19937_64 rng(11);
+    // Lengths around multiples of the 4 words per AVX2 operation, so every tail length is covered.
+    for (std::size_t n = 0; n <= 37; ++n) {
+        INFO("n = " << n);
+        std::vector<std::uint64_t> a(n), b(n);
+        for (std::uint64_t& word : a) word = rng();
+        for (std::uint64_t& word : b) word = rng();
+
+        std::size_t expected_count = 0;
+        for (std::uint64_t word : a) expected_count += static_cast<std::size_t>(std::popcount(word));
+        CHECK(plib::popcount(std::span<std::uint64_t const>(a)) == expected_count);
+        CHECK(plib::detail::popcount_portable(a) == expected_count);
+
+        auto check = [&](auto kernel, auto scalar) {
+            std::vector<std::uint64_t> dst = a;
+            kernel(std::span<std::uint64_t>(dst), std::span<std::uint64_t const>(b));
+            for (std::size_t i = 0; i < n; ++i) REQUIRE(dst[i] == scalar(a[i], b[i]));
+        };
+        auto bit_and = [](std::uint64_t x, std::uint64_t y) { return x & y; };
+        auto bit_or = [](std::uint64_t x, std::uint64_t y) { return x | y; };
+        auto bit_xor = [](std::uint64_t x, std::uint64_t y) { return x ^ y; };
+        auto bit_and_not = [](std::uint64_t x, std::uint64_t y) { return x & ~y; };
+
+        check([](auto dst, auto src) { plib::bit_and(dst, src); }, bit_and);
+        check([](auto dst, auto src) { plib::bit_or(dst, src); }, bit_or);
+        check([](auto dst, auto src) { plib::bit_xor(dst, src); }, bit_xor);
+        check([](auto dst, auto src) { plib::bit_and_not(dst, src); }, bit_and_not);
+        check([](auto dst, auto src) { plib::detail::and_portable(dst, src); }, bit_and);
+        check([](auto dst, auto src) { plib::detail::or_portable(dst, src); }, bit_or);
+        check([](auto dst, auto src) { plib::detail::xor_portable(dst, src); }, bit_xor);
+        check([](auto dst, auto src) { plib::detail::and_not_portable(dst, src); }, bit_and_not);
+#if defined(PLIB_BITS_X86)
+        if (plib::cpu_features.avx2) {
+            CHECK(plib::detail::popcount_avx2(a.data(), n) == expected_count);
+            check([](auto dst, auto src) { plib::detail::and_avx2(dst.data(), src.data(), dst.size()); }, bit_and);
+            check([](auto dst, auto src) { plib::detail::or_avx2(dst.data(), src.data(), dst.size()); }, bit_or);
+            check([](auto dst, auto src) { plib::detail::xor_avx2(dst.data(), src.data(), dst.size()); }, bit_xor);
+            check([](auto dst, auto src) { plib::detail::and_not_avx2(dst.data(), src.data(), dst.size()); }, bit_and_not);
+        }
+        if (plib::cpu_features.popcnt) {
+            CHECK(plib::detail::popcount_popcnt(a.data(), n) == expected_count);
+        }
+#endif
+    }
+
+    std::vector<std::uint64_t> dst(4), src(5);
+    CHECK_THROWS_AS(plib::bit_and(dst, src), std::invalid_argument);
+    CHECK_THROWS_AS(plib::bit_and_not(dst, src), std::invalid_argument);
+}
+
+TEST_CASE("log2 and bit reversal", "[bits]") {
+    CHECK(plib::log2_ceil(0u) == 0);
+    CHECK(plib::log2_ceil(1u) == 0);
+    CHECK(plib::log2_floor(0u) == -1);
+    CHECK(plib::log2_floor(1u) == 0);
+    for (int k = 1; k < 64; ++k) {
+        std::uint64_t const power = std::uint64_t(1) << k;
+        INFO("k = " << k);
+        CHECK(plib::log2_ceil(power) == k);
+        CHECK(plib::log2_ceil(power - 1) == (k == 1 ? 0 : k));
+        CHECK(plib::log2_ceil(power + 1) == k + 1);
+        CHECK(plib::log2_floor(power) == k);
+        CHECK(plib::log2_floor(power - 1) == k - 1);
+    }
+    CHECK(plib::log2_ceil(~std::uint64_t(0)) == 64);
+    CHECK(plib::log2_ceil(std::uint8_t(200)) == 8);
+
+    std::mt19937_64 rng(3);
+    for (int i = 0; i < 1000; ++i) {
+        std::uint64_t const word = rng();
+        std::uint64_t reversed = 0;
+        for (int bit = 0; bit < 64; ++bit) reversed |= ((word >> bit) & 1) << (63 - bit);
+        REQUIRE(plib::bit_reverse(word) == reversed);
+        REQUIRE(plib::bit_reverse(static_cast<std::uint32_t>(word)) == static_cast<std::uint32_t>(reversed >> 32));
+    }
+}
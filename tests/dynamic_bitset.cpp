@@ -0,0 +1,124 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/dynamic_bitset.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+plib::dynamic_bitset random_bitset(std::size_t size, double density, std::mt19937_64& rng) {
+    std::bernoulli_distribution bit(density);
+    plib::dynamic_bitset set(size);
+    for (std::size_t i = 0; i < size; ++i) set.set(i, bit(rng));
+    return set;
+}
+
+std::vector<bool> to_bools(plib::dynamic_bitset const& set) {
+    std::vector<bool> bools(set.size());
+    for (std::size_t i = 0; i < set.size(); ++i) bools[i] = set[i];
+    return bools;
+}
+
+}
+
+TEST_CASE("dynamic_bitset rank and select match a brute-force count", "[dynamic_bitset]") {
+    std::mt19937_64 rng(5);
+    // Sizes around word (64) and superblock (512) boundaries.
+    for (std::size_t size : { 0, 1, 63, 64, 65, 200, 511, 512, 513, 1000, 1024, 1537, 5000 }) {
+        for (double density : { 0.0, 0.02, 0.5, 1.0 }) {
+            INFO("size " << size << ", density " << density);
+            plib::dynamic_bitset const set = random_bitset(size, density, rng);
+            plib::bitset_rank_index const index(set);
+
+            std::size_t rank = 0;
+            std::vector<std::size_t> positions;
+            for (std::size_t i = 0; i <= size; ++i) {
+                REQUIRE(index.rank(i) == rank);
+                if (i < size && set[i]) {
+                    positions.push_back(i);
+                    ++rank;
+                }
+            }
+            REQUIRE(index.count() == positions.size());
+            REQUIRE(set.count() == positions.size());
+            for (std::size_t k = 0; k < positions.size(); ++k) {
+                REQUIRE(index.select(k) == positions[k]);
+            }
+            CHECK(index.select(positions.size()) == plib::dynamic_bitset::npos);
+        }
+    }
+}
+
+TEST_CASE("dynamic_bitset set operations match per-bit operations", "[dynamic_bitset]") {
+    std::mt19937_64 rng(9);
+    for (std::size_t size : { 1, 64, 100, 255, 256, 257, 1000 }) {
+        INFO("size " << size);
+        plib::dynamic_bitset const a = random_bitset(size, 0.5, rng);
+        plib::dynamic_bitset const b = random_bitset(size, 0.3, rng);
+        std::vector<bool> const x = to_bools(a);
+        std::vector<bool> const y = to_bools(b);
+
+        plib::dynamic_bitset and_not = a;
+        and_not.and_not(b);
+        plib::dynamic_bitset const both = a & b;
+        plib::dynamic_bitset const either = a | b;
+        plib::dynamic_bitset const one = a ^ b;
+        plib::dynamic_bitset const inverse = ~a;
+        for (std::size_t i = 0; i < size; ++i) {
+            REQUIRE(both[i] == (x[i] && y[i]));
+            REQUIRE(either[i] == (x[i] || y[i]));
+            REQUIRE(one[i] == (x[i] != y[i]));
+            REQUIRE(and_not[i] == (x[i] && !y[i]));
+            REQUIRE(inverse[i] == !x[i]);
+        }
+        // Flipping must not set the unused bits of the last word.
+        CHECK(inverse.count() == size - a.count());
+        CHECK((a | inverse).all());
+
+        std::vector<std::size_t> iterated, visited;
+        for (std::size_t i : a.set_bits()) iterated.push_back(i);
+        a.for_each_set([&](std::size_t i) { visited.push_back(i); });
+        std::vector<std::size_t> expected;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (x[i]) expected.push_back(i);
+        }
+        CHECK(iterated == expected);
+        CHECK(visited == expected);
+    }
+
+    plib::dynamic_bitset a(10), b(11);
+    CHECK_THROWS_AS(a &= b, std::invalid_argument);
+}
+
+TEST_CASE("dynamic_bitset resize keeps the bits past the size clear", "[dynamic_bitset]") {
+    plib::dynamic_bitset set(100, true);
+    CHECK(set.count() == 100);
+    CHECK(set.all());
+
+    set.resize(70);
+    CHECK(set.count() == 70);
+    CHECK(set.data().back() == (~std::uint64_t(0) >> (128 - 70)));
+
+    // Growing again must not bring back the bits that were cut off.
+    set.resize(130);
+    CHECK(set.count() == 70);
+    CHECK_FALSE(set.test(70));
+    CHECK_FALSE(set.test(99));
+    CHECK(set.find_next(69) == plib::dynamic_bitset::npos);
+
+    set.resize(200, true);
+    CHECK(set.count() == 140);
+    CHECK_FALSE(set.test(129));
+    CHECK(set.test(130));
+    CHECK(set.data().back() == (~std::uint64_t(0) >> (256 - 200)));
+
+    set.set();
+    CHECK(set.count() == 200);
+    set.reset();
+    CHECK(set.none());
+    CHECK(set.find_first() == plib::dynamic_bitset::npos);
+}
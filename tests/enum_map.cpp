@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/enum_map.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+enum class direction : std::uint8_t { north, east, south, west, count };
+
+enum class level : std::int16_t { low = -1, normal, high };
+
+struct tracked {
+    static inline int constructed = 0;
+    static inline int destroyed = 0;
+
+    std::string text = "default";
+
+    tracked() { ++constructed; }
+    tracked(tracked const& rhs) : text(rhs.text) { ++constructed; }
+    tracked& operator=(tracked const&) = default;
+    ~tracked() { ++destroyed; }
+};
+
+}
+
+template<>
+struct plib::enum_range<level> {
+    static constexpr std::int16_t min = -1;
+    static constexpr std::int16_t max = 1;
+};
+
+namespace {
+
+constexpr plib::enum_map<direction, int> degrees { { direction::north, 0 }, { direction::east, 90 }, { direction::south, 180 }, { direction::west, 270 } };
+static_assert(degrees[direction::south] == 180);
+static_assert(plib::enum_map<direction, int>::size() == 4);
+
+}
+
+TEST_CASE("enum_map stores a value for every key", "[enum_map]") {
+    plib::enum_map<direction, std::string> names { { direction::north, "N" }, { direction::west, "W" } };
+    CHECK(names[direction::north] == "N");
+    CHECK(names[direction::east].empty());
+    names[direction::east] = "E";
+    CHECK(names.at(direction::east) == "E");
+    CHECK_THROWS_AS(names.at(static_cast<direction>(4)), std::out_of_range);
+
+    std::vector<direction> keys;
+    std::string joined;
+    names.for_each([&](direction key, std::string& value) {
+        keys.push_back(key);
+        joined += value.empty() ? "-" : value;
+    });
+    CHECK(keys == std::vector { direction::north, direction::east, direction::south, direction::west });
+    CHECK(joined == "NE-W");
+
+    std::string iterated;
+    for (std::string const& value : names) iterated += value;
+    CHECK(iterated == "NEW");
+
+    names.fill("x");
+    CHECK(names == plib::enum_map<direction, std::string> { { direction::north, "x" }, { direction::east, "x" }, { direction::south, "x" }, { direction::west, "x" } });
+}
+
+TEST_CASE("enum_map with a custom enum_range", "[enum_map]") {
+    plib::enum_map<level, int> map { { level::low, -10 }, { level::high, 10 } };
+    CHECK(map.size() == 3);
+    CHECK(map[level::low] == -10);
+    CHECK(map[level::normal] == 0);
+    CHECK(map.at(level::high) == 10);
+    CHECK_THROWS_AS(map.at(static_cast<level>(2)), std::out_of_range);
+    CHECK_THROWS_AS(map.at(static_cast<level>(-2)), std::out_of_range);
+
+    int sum = 0;
+    std::vector<level> keys;
+    std::as_const(map).for_each([&](level key, int const& value) {
+        keys.push_back(key);
+        sum += value;
+    });
+    CHECK(keys == std::vector { level::low, level::normal, level::high });
+    CHECK(sum == 0);
+}
+
+TEST_CASE("enum_map constructs and destroys non-trivial values", "[enum_map]") {
+    tracked::constructed = 0;
+    tracked::destroyed = 0;
+    {
+        plib::enum_map<direction, tracked> map;
+        CHECK(tracked::constructed == 4);
+        map[direction::south].text = "changed";
+
+        plib::enum_map<direction, tracked> copy = map;
+        CHECK(tracked::constructed == 8);
+        CHECK(copy[direction::south].text == "changed");
+        CHECK(copy[direction::north].text == "default");
+    }
+    CHECK(tracked::destroyed == tracked::constructed);
+}
@@ -0,0 +1,101 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/enum_set.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+enum class color : std::uint8_t { red, green, blue, count };
+
+// More enumerators than fit in one word.
+enum class opcode : std::uint16_t { first = 0, last = 99, count };
+
+// No count enumerator and a negative minimum, described by a custom enum_range.
+enum class offset : std::int8_t { minus_two = -2, minus_one, zero, one, two, three };
+
+}
+
+template<>
+struct plib::enum_range<offset> {
+    static constexpr std::int8_t min = -2;
+    static constexpr std::int8_t max = 3;
+};
+
+namespace {
+
+static_assert(plib::enum_size_v<color> == 3);
+static_assert(plib::enum_size_v<opcode> == 100);
+static_assert(plib::enum_size_v<offset> == 6);
+static_assert(plib::enum_index(offset::minus_two) == 0);
+static_assert(plib::enum_index(offset::three) == 5);
+static_assert(plib::enum_from_index<offset>(1) == offset::minus_one);
+static_assert(plib::enum_set<color> { color::red, color::blue }.size() == 2);
+static_assert(plib::enum_set<color>::all().contains(color::green));
+
+template<typename E>
+std::vector<E> elements(plib::enum_set<E> const& set) {
+    std::vector<E> result;
+    set.for_each([&](E e) { result.push_back(e); });
+    return result;
+}
+
+}
+
+TEST_CASE("enum_set insert, erase and contains", "[enum_set]") {
+    plib::enum_set<color> set;
+    CHECK(set.empty());
+    set.insert(color::blue).insert(color::red);
+    CHECK(set.contains(color::red));
+    CHECK_FALSE(set.contains(color::green));
+    CHECK(set.contains(color::blue));
+    CHECK(set.size() == 2);
+
+    set.insert(color::red);
+    CHECK(set.size() == 2);
+    set.erase(color::red);
+    CHECK_FALSE(set.contains(color::red));
+    set.erase(color::red);
+    CHECK(set.size() == 1);
+    set.toggle(color::green).toggle(color::blue);
+    CHECK(set == plib::enum_set<color> { color::green });
+
+    set.clear();
+    CHECK(set.empty());
+}
+
+TEST_CASE("enum_set iterates in enumerator order", "[enum_set]") {
+    plib::enum_set<color> const set { color::blue, color::red };
+    CHECK(elements(set) == std::vector { color::red, color::blue });
+
+    plib::enum_set<opcode> ops;
+    for (int i : { 99, 64, 63, 0, 1 }) ops.insert(static_cast<opcode>(i));
+    std::vector<opcode> const expected { opcode(0), opcode(1), opcode(63), opcode(64), opcode(99) };
+    CHECK(elements(ops) == expected);
+}
+
+TEST_CASE("enum_set complement stays inside the range", "[enum_set]") {
+    auto const all = plib::enum_set<opcode>::all();
+    CHECK(all.size() == 100);
+    CHECK((~all).empty());
+
+    plib::enum_set<opcode> const some { opcode(3), opcode(70) };
+    CHECK((~some).size() == 98);
+    CHECK((some | ~some) == all);
+    CHECK((some & ~some).empty());
+    CHECK((some ^ all) == ~some);
+}
+
+TEST_CASE("enum_set with a custom enum_range", "[enum_set]") {
+    plib::enum_set<offset> set { offset::minus_two, offset::three, offset::zero };
+    CHECK(set.size() == 3);
+    CHECK(set.contains(offset::minus_two));
+    CHECK(set.contains(offset::three));
+    CHECK_FALSE(set.contains(offset::minus_one));
+    CHECK(elements(set) == std::vector { offset::minus_two, offset::zero, offset::three });
+    CHECK(plib::enum_set<offset>::all().size() == 6);
+    set.erase(offset::minus_two);
+    CHECK(elements(set) == std::vector { offset::zero, offset::three });
+}
@@ -0,0 +1,268 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/erased_function.hpp>
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+int add(int a, int b) {
+    return a + b;
+}
+
+int side_effect_total = 0;
+
+void accumulate(int x) {
+    side_effect_total += x;
+}
+
+// Only implements call(), so call_batch() goes through the default row-by-row implementation.
+class subtract_function : public plib::erased_function<int> {
+public:
+    using plib::erased_function<int>::call;
+
+    void call(std::span<int const> args, int* ret) override {
+        plib::detail::check_arity(args, 2);
+        if (ret) *ret = args[0] - args[1];
+    }
+
+    std::size_t arity() const override {
+        return 2;
+    }
+};
+
+using columns_type = std::array<std::span<int const>, 2>;
+
+// Counts every instance, so double destruction and leaks both show up as a mismatch.
+struct counting_functor {
+    static inline int constructed = 0;
+    static inline int destroyed = 0;
+
+    std::array<int, 4> padding {};
+    int offset = 0;
+
+    explicit counting_functor(int offset) : offset(offset) { ++constructed; }
+    counting_functor(counting_functor const& rhs) : padding(rhs.padding), offset(rhs.offset) { ++constructed; }
+    counting_functor(counting_functor&& rhs) noexcept : padding(rhs.padding), offset(rhs.offset) { ++constructed; }
+    ~counting_functor() { ++destroyed; }
+
+    int operator()(int x) const {
+        return x + offset;
+    }
+};
+
+// Same, but too large for the inline buffer.
+struct large_counting_functor : counting_functor {
+    std::array<char, 128> data {};
+
+    using counting_functor::counting_functor;
+};
+
+struct counter {
+    int total = 0;
+
+    int add(int x) {
+        total += x;
+        return total;
+    }
+
+    int get() const {
+        return total;
+    }
+};
+
+}
+
+TEST_CASE("call_batch calls the function for every row", "[erased_function]") {
+    std::vector<int> const lhs { 1, 2, 3, 4, 5 };
+    std::vector<int> const rhs { 10, 20, 30, 40, 50 };
+    columns_type const columns { std::span<int const>(lhs), std::span<int const>(rhs) };
+
+    auto check_batch = [&](plib::erased_function<int>& function, auto expected) {
+        std::vector<int> results(lhs.size(), -1);
+        function.call_batch(lhs.size(), columns, results.data());
+        for (std::size_t i = 0; i < lhs.size(); ++i) CHECK(results[i] == expected(lhs[i], rhs[i]));
+
+        // Fewer rows than the columns hold, and discarded results.
+        std::vector<int> partial(2, -1);
+        function.call_batch(2, columns, partial.data());
+        CHECK(partial[1] == expected(lhs[1], rhs[1]));
+        function.call_batch(lhs.size(), columns, nullptr);
+
+        // Every column must hold count values, and there must be one column per parameter.
+        CHECK_THROWS_AS(function.call_batch(lhs.size() + 1, columns, results.data()), std::invalid_argument);
+        std::array<std::span<int const>, 1> const too_few { std::span<int const>(lhs) };
+        CHECK_THROWS_AS(function.call_batch(1, too_few, results.data()), std::invalid_argument);
+        columns_type const short_column { std::span<int const>(lhs), std::span<int const>(rhs).first(3) };
+        CHECK_THROWS_AS(function.call_batch(4, short_column, results.data()), std::invalid_argument);
+    };
+
+    SECTION("default implementation") {
+        subtract_function function;
+        check_batch(function, [](int a, int b) { return a - b; });
+    }
+
+    SECTION("concrete_function") {
+        plib::concrete_function<int(int, int), int, plib::pack<int, int>> function(&add);
+        check_batch(function, [](int a, int b) { return a + b; });
+    }
+
+    SECTION("callable_function") {
+        int const factor = 3;
+        auto function = plib::make_function<int>([factor](int a, int b) { return factor * a + b; });
+        check_batch(*function, [&](int a, int b) { return factor * a + b; });
+    }
+
+    SECTION("functions without a return value") {
+        side_effect_total = 0;
+        auto function = plib::make_function<int>(&accumulate);
+        std::array<std::span<int const>, 1> const column { std::span<int const>(lhs) };
+        function->call_batch(lhs.size(), column, nullptr);
+        CHECK(side_effect_total == 15);
+        CHECK_THROWS_AS(function->call_batch(lhs.size() + 1, column, nullptr), std::invalid_argument);
+    }
+}
+
+TEST_CASE("concrete_function with a custom Create", "[erased_function]") {
+    auto twice = [](int x) { return 2 * x; };
+
+    SECTION("Create spelled out") {
+        plib::concrete_function<int(int, int), int, plib::pack<int, int>, decltype(twice)> function(&add, twice);
+        CHECK(function.call(1, 2) == 6);
+    }
+
+    SECTION("deduced from the constructor arguments") {
+        plib::concrete_function function(&add, twice);
+        static_assert(std::is_same_v<decltype(function), plib::concrete_function<int(int, int), int, plib::pack<int, int>, decltype(twice)>>);
+        CHECK(function.call(1, 2) == 6);
+    }
+
+    SECTION("make_concrete_function") {
+        auto* function = plib::make_concrete_function<int>(&add, twice);
+        CHECK(function->call(3, 4) == 14);
+        delete function;
+    }
+}
+
+TEST_CASE("inline_function stores small callables inline", "[erased_function]") {
+    counting_functor::constructed = 0;
+    counting_functor::destroyed = 0;
+    {
+        auto small = plib::make_function<int>(counting_functor(1));
+        using small_type = plib::callable_function<int, counting_functor>;
+        static_assert(plib::inline_function<int>::fits_inline<small_type>);
+        CHECK(small.is_inline());
+        CHECK(small->call(41) == 42);
+
+        auto large = plib::make_function<int>(large_counting_functor(2));
+        using large_type = plib::callable_function<int, large_counting_functor>;
+        static_assert(!plib::inline_function<int>::fits_inline<large_type>);
+        CHECK_FALSE(large.is_inline());
+        CHECK(large->call(40) == 42);
+
+        // Only a non-throwing move is needed to be stored inline.
+        auto capturing = plib::make_function<int>([text = std::string("a string that is too long for SSO")](int x) { return x + static_cast<int>(text.size()); });
+        CHECK(capturing.is_inline());
+        plib::inline_function<int> moved_capturing = std::move(capturing);
+        CHECK(moved_capturing->call(0) == 33);
+
+        SECTION("moving relocates inline functions and transfers heap ones") {
+            plib::erased_function<int>* const inline_object = small.get();
+            plib::erased_function<int>* const heap_object = large.get();
+            plib::inline_function<int> moved_small = std::move(small);
+            plib::inline_function<int> moved_large = std::move(large);
+            CHECK_FALSE(small);
+            CHECK_FALSE(large);
+            CHECK(moved_small.is_inline());
+            CHECK(moved_small.get() != inline_object);
+            CHECK(moved_small->call(1) == 2);
+            CHECK(moved_large.get() == heap_object);
+            CHECK(moved_large->call(1) == 3);
+
+            // Move assignment destroys the previous function first.
+            int const destroyed_before = counting_functor::destroyed;
+            moved_small = std::move(moved_large);
+            CHECK(counting_functor::destroyed == destroyed_before + 1);
+            CHECK(moved_small->call(1) == 3);
+            CHECK_FALSE(moved_small.is_inline());
+        }
+
+        SECTION("reset destroys the function once") {
+            int const destroyed_before = counting_functor::destroyed;
+            small.reset();
+            large.reset();
+            CHECK(counting_functor::destroyed == destroyed_before + 2);
+            small.reset();
+            CHECK(counting_functor::destroyed == destroyed_before + 2);
+        }
+
+        SECTION("in a vector that reallocates") {
+            std::vector<plib::inline_function<int>> functions;
+            for (int i = 0; i < 50; ++i) functions.push_back(plib::make_function<int>(counting_functor(i)));
+            for (int i = 0; i < 50; ++i) CHECK(functions[i]->call(100) == 100 + i);
+        }
+    }
+    CHECK(counting_functor::constructed == counting_functor::destroyed);
+}
+
+TEST_CASE("make_function binds member functions to an object", "[erased_function]") {
+    counter object;
+    auto add_to = plib::make_function<int>(&counter::add, &object);
+    auto get = plib::make_function<int>(&counter::get, &object);
+    CHECK(add_to->arity() == 1);
+    CHECK(get->arity() == 0);
+    CHECK(add_to.is_inline());
+
+    CHECK(add_to->call(5) == 5);
+    CHECK(add_to->call(3) == 8);
+    CHECK(object.total == 8);
+    CHECK(get->call() == 8);
+
+    SECTION("with a Create callback") {
+        auto negated = plib::make_function<int>(&counter::get, &object, [](int x) { return -x; });
+        CHECK(negated->call() == -8);
+    }
+
+    SECTION("const objects") {
+        counter const& const_object = object;
+        auto const_get = plib::make_function<int>(&counter::get, &const_object);
+        CHECK(const_get->call() == 8);
+    }
+}
+
+TEST_CASE("erased_function dispatches through the span entry point", "[erased_function]") {
+    plib::concrete_function<int(int, int), int, plib::pack<int, int>> function(&add);
+    plib::erased_function<int>& erased = function;
+    CHECK(erased.arity() == 2);
+
+    std::array<int, 2> const args { 2, 5 };
+    int result = 0;
+    erased.call(std::span<int const>(args), &result);
+    CHECK(result == 7);
+    // A null result pointer discards the return value.
+    erased.call(std::span<int const>(args), nullptr);
+
+    std::array<int, 3> const too_many { 1, 2, 3 };
+    CHECK_THROWS_AS(erased.call(std::span<int const>(too_many), &result), std::invalid_argument);
+    CHECK_THROWS_AS(erased.call(1), std::invalid_argument);
+    CHECK(result == 7);
+
+    // The convenience overloads pack their arguments into the same entry point.
+    CHECK(erased.call(20, 22) == 42);
+    CHECK(function(1, 1) == 2);
+
+    side_effect_total = 0;
+    plib::concrete_function<void(int), int, plib::pack<int>> void_function(&accumulate);
+    result = -1;
+    void_function.call(std::span<int const>(args).first(1), &result);
+    CHECK(result == -1);
+    void_function.call_void(3);
+    CHECK(side_effect_total == 5);
+}
@@ -0,0 +1,170 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/flat_hash_map.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+namespace {
+
+// Puts every key in one of a few buckets, so runs of full slots are long and erase has to shift many elements.
+struct colliding_hash {
+    std::size_t operator()(int key) const noexcept {
+        return std::size_t(key % 4);
+    }
+};
+
+template<typename Map>
+void check_equal(Map const& map, std::unordered_map<int, int> const& expected) {
+    REQUIRE(map.size() == expected.size());
+    std::size_t visited = 0;
+    for (auto const& [key, value] : map) {
+        auto it = expected.find(key);
+        REQUIRE(it != expected.end());
+        CHECK(it->second == value);
+        ++visited;
+    }
+    CHECK(visited == expected.size());
+    for (auto const& [key, value] : expected) {
+        REQUIRE(map.contains(key));
+        CHECK(map.at(key) == value);
+    }
+}
+
+template<typename Map>
+void differential_test(std::uint32_t seed, int key_range) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> key_dist(0, key_range - 1);
+    std::uniform_int_distribution<int> op_dist(0, 99);
+
+    Map map;
+    std::unordered_map<int, int> expected;
+    for (int step = 0; step < 20'000; ++step) {
+        int const key = key_dist(rng);
+        int const op = op_dist(rng);
+        if (op < 45) {
+            auto [it, inserted] = map.try_emplace(key, step);
+            auto [expected_it, expected_inserted] = expected.try_emplace(key, step);
+            REQUIRE(inserted == expected_inserted);
+            CHECK(it->first == key);
+            CHECK(it->second == expected_it->second);
+        } else if (op < 55) {
+            map.insert_or_assign(key, step);
+            expected.insert_or_assign(key, step);
+        } else if (op < 60) {
+            map[key] += 1;
+            expected[key] += 1;
+        } else if (op < 90) {
+            REQUIRE(map.erase(key) == expected.erase(key));
+        } else if (op < 99) {
+            auto it = map.find(key);
+            auto expected_it = expected.find(key);
+            REQUIRE((it == map.end()) == (expected_it == expected.end()));
+            if (it != map.end()) CHECK(it.value() == expected_it->second);
+        } else {
+            int const divisor = 2 + step % 5;
+            auto pred = [divisor](auto const& element) { return element.second % divisor == 0; };
+            REQUIRE(map.erase_if(pred) == std::erase_if(expected, pred));
+        }
+        if (step % 1000 == 0) check_equal(map, expected);
+    }
+    check_equal(map, expected);
+
+    auto all = [](auto const&) { return true; };
+    CHECK(plib::erase_if(map, all) == expected.size());
+    CHECK(map.empty());
+    CHECK(map.begin() == map.end());
+}
+
+}
+
+TEST_CASE("flat_hash_map matches std::unordered_map", "[flat_hash_map]") {
+    SECTION("small key range") {
+        for (std::uint32_t seed : { 1u, 2u, 3u }) differential_test<plib::flat_hash_map<int, int>>(seed, 64);
+    }
+    SECTION("large key range") {
+        for (std::uint32_t seed : { 1u, 2u, 3u }) differential_test<plib::flat_hash_map<int, int>>(seed, 5000);
+    }
+    SECTION("colliding hashes") {
+        for (std::uint32_t seed : { 1u, 2u, 3u }) differential_test<plib::flat_hash_map<int, int, colliding_hash>>(seed, 300);
+    }
+}
+
+TEST_CASE("flat_hash_map erase_if visits shifted elements", "[flat_hash_map]") {
+    // Every key has the same home slot, so each erase shifts all later keys back by one.
+    plib::flat_hash_map<int, int, colliding_hash> map;
+    for (int i = 0; i < 200; ++i) map.try_emplace(i * 4, i);
+    CHECK(map.erase_if([](auto const& element) { return element.second % 3 != 0; }) == 133);
+    CHECK(map.size() == 67);
+    for (auto const& [key, value] : map) CHECK(value % 3 == 0);
+}
+
+TEST_CASE("flat_hash_map copy, move and clear", "[flat_hash_map]") {
+    plib::flat_hash_map<int, int> map { { 1, 10 }, { 2, 20 }, { 3, 30 } };
+
+    plib::flat_hash_map<int, int> copy = map;
+    copy.at(1) = 11;
+    CHECK(map.at(1) == 10);
+    CHECK(copy.size() == 3);
+
+    plib::flat_hash_map<int, int> moved = std::move(copy);
+    CHECK(moved.at(1) == 11);
+    CHECK(moved.size() == 3);
+
+    CHECK_THROWS_AS(map.at(4), std::out_of_range);
+
+    map.clear();
+    CHECK(map.empty());
+    CHECK_FALSE(map.contains(1));
+    map[5] = 50;
+    CHECK(map.at(5) == 50);
+
+    moved.reserve(1000);
+    CHECK(moved.capacity() >= 1000);
+    CHECK(moved.at(2) == 20);
+}
+
+TEST_CASE("flat_hash_map looks up std::string keys by std::string_view", "[flat_hash_map]") {
+    plib::flat_hash_map<std::string, int> map;
+    map["alpha"] = 1;
+    map.try_emplace("a key that is too long for the small string buffer", 2);
+
+    std::string_view const alpha = "alpha";
+    CHECK(map.contains(alpha));
+    CHECK(map.at(alpha) == 1);
+    CHECK(map.find("a key that is too long for the small string buffer").value() == 2);
+    CHECK(map.find(std::string_view("beta")) == map.end());
+    CHECK(map.count("alpha") == 1);
+
+    CHECK(map.erase(alpha) == 1);
+    CHECK(map.erase(std::string_view("alpha")) == 0);
+    CHECK(map.size() == 1);
+}
+
+TEST_CASE("flat_hash_map values can be modified through iterators", "[flat_hash_map]") {
+    plib::flat_hash_map<std::string, int> map;
+    for (int i = 0; i < 100; ++i) map[std::to_string(i)] = i;
+
+    static_assert(std::is_same_v<decltype(*map.begin()), std::pair<std::string const, int>&>);
+    static_assert(std::is_same_v<decltype(*map.cbegin()), std::pair<std::string const, int> const&>);
+
+    auto it = map.find("42");
+    REQUIRE(it != map.end());
+    it->second = -42;
+    CHECK(map.at("42") == -42);
+
+    for (auto& [key, value] : map) value = static_cast<int>(key.size());
+    for (auto const& [key, value] : map) CHECK(value == static_cast<int>(key.size()));
+
+    // Rehashing and backward shift deletion relocate the elements built through the pair references.
+    map.reserve(1000);
+    for (int i = 0; i < 100; i += 2) CHECK(map.erase(std::to_string(i)) == 1);
+    CHECK(map.size() == 50);
+    for (int i = 1; i < 100; i += 2) CHECK(map.at(std::to_string(i)) == static_cast<int>(std::to_string(i).size()));
+}
@@ -0,0 +1,104 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/function_registry.hpp>
+
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto builtin_names = plib::make_name_table({ "print", "len", "abs", "min", "max", "floor", "ceil", "sqrt" });
+
+static_assert(builtin_names.index_of("print") == 0);
+static_assert(builtin_names.index_of("sqrt") == 7);
+static_assert(builtin_names.index_of("pow") == plib::invalid_function_id);
+static_assert(builtin_names.index_of("") == plib::invalid_function_id);
+
+int negate(int x) {
+    return -x;
+}
+
+int add(int a, int b) {
+    return a + b;
+}
+
+}
+
+TEST_CASE("static_name_table resolves every name to its index", "[function_registry]") {
+    for (std::uint32_t id = 0; id < builtin_names.size(); ++id) {
+        CHECK(builtin_names.index_of(builtin_names.name(id)) == id);
+    }
+    CHECK_THROWS_AS(builtin_names.name(plib::invalid_function_id), std::logic_error);
+    CHECK_THROWS_AS(builtin_names.name(builtin_names.size()), std::logic_error);
+}
+
+TEST_CASE("function_registry resolves every name", "[function_registry]") {
+    plib::function_registry<int> registry;
+    std::vector<std::string> names;
+    for (int i = 0; i < 1000; ++i) {
+        names.push_back("function_" + std::to_string(i));
+        CHECK(registry.add(names.back(), plib::make_function<int>(&negate)) == static_cast<std::uint32_t>(i));
+    }
+    CHECK_THROWS_AS(registry.resolve("function_0"), std::logic_error);
+    registry.build();
+
+    for (std::uint32_t id = 0; id < names.size(); ++id) {
+        CHECK(registry.resolve(names[id]) == id);
+        CHECK(registry.name(id) == names[id]);
+    }
+
+    SECTION("unknown names") {
+        for (char const* name : { "", "function_", "function_1000", "function_01", "Function_1", "x" }) {
+            CHECK(registry.resolve(name) == plib::invalid_function_id);
+        }
+    }
+
+    SECTION("calling an unresolved name throws") {
+        std::array<int, 1> const args { 1 };
+        int result = 0;
+        std::uint32_t const missing = registry.resolve("missing");
+        REQUIRE(missing == plib::invalid_function_id);
+        CHECK_THROWS_AS(registry.call(missing, std::span<int const>(args), &result), std::logic_error);
+        CHECK_THROWS_AS(registry[missing], std::logic_error);
+        CHECK_THROWS_AS(registry.name(missing), std::logic_error);
+        CHECK_THROWS_AS(registry.name(static_cast<std::uint32_t>(names.size())), std::logic_error);
+    }
+
+    SECTION("rebuild after adding more names") {
+        std::uint32_t const id = registry.add("add", plib::make_function<int>(&add));
+        registry.build();
+        CHECK(registry.resolve("add") == id);
+        CHECK(registry.resolve("function_500") == 500);
+    }
+}
+
+TEST_CASE("function_registry dispatches by id", "[function_registry]") {
+    plib::function_registry<int> registry(builtin_names);
+    std::uint32_t const abs_id = builtin_names.index_of("abs");
+    std::uint32_t const max_id = registry.resolve("max");
+
+    SECTION("unbound ids throw") {
+        std::array<int, 1> const args { 1 };
+        CHECK_THROWS_AS(registry[abs_id], std::logic_error);
+        CHECK_THROWS_AS(registry.call(abs_id, std::span<int const>(args), nullptr), std::logic_error);
+    }
+
+    registry.bind(abs_id, plib::make_function<int>(&negate));
+    registry.bind(max_id, plib::make_function<int>(&add));
+
+    std::array<int, 1> const one { 5 };
+    int result = 0;
+    registry.call(abs_id, std::span<int const>(one), &result);
+    CHECK(result == -5);
+    CHECK(registry[max_id].call(2, 3) == 5);
+}
+
+TEST_CASE("function_registry rejects duplicate names", "[function_registry]") {
+    plib::function_registry<int> registry;
+    registry.add("same", plib::make_function<int>(&negate));
+    registry.add("same", plib::make_function<int>(&negate));
+    CHECK_THROWS_AS(registry.build(), std::invalid_argument);
+}
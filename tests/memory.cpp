@@ -0,0 +1,262 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/memory.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Upstream resource that records every allocation and checks that it is returned with the same size and alignment.
+class checking_resource : public std::pmr::memory_resource {
+public:
+    ~checking_resource() override {
+        CHECK(live.empty());
+    }
+
+    std::size_t allocations = 0;
+    std::size_t mismatched = 0;
+    std::vector<std::size_t> sizes;
+    std::map<void*, std::pair<std::size_t, std::size_t>> live;
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* ptr = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        ++allocations;
+        sizes.push_back(bytes);
+        live.emplace(ptr, std::pair(bytes, alignment));
+        return ptr;
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        auto it = live.find(ptr);
+        if (it == live.end() || it->second != std::pair(bytes, alignment)) {
+            ++mismatched;
+            return;
+        }
+        live.erase(it);
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+bool is_aligned(void const* ptr, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+struct counted {
+    static inline int alive = 0;
+    int value;
+
+    explicit counted(int value) : value(value) {
+        if (value < 0) throw std::invalid_argument("negative");
+        ++alive;
+    }
+
+    virtual ~counted() {
+        --alive;
+    }
+};
+
+struct alignas(64) counted_derived : counted {
+    char padding[100] {};
+
+    explicit counted_derived(int value) : counted(value) {}
+};
+
+}
+
+TEST_CASE("monotonic_arena", "[memory]") {
+    checking_resource upstream;
+
+    SECTION("over-aligned allocations") {
+        plib::monotonic_arena arena(256, &upstream);
+        for (std::size_t alignment : { 1, 2, 8, 16, 32, 64, 128, 256, 4096 }) {
+            arena.allocate(1, 1);
+            void* ptr = arena.allocate(24, alignment);
+            CHECK(is_aligned(ptr, alignment));
+        }
+        struct alignas(128) wide {
+            int x = 1;
+        };
+        CHECK(is_aligned(arena.create<wide>(), 128));
+    }
+
+    SECTION("blocks grow geometrically, large allocations get their own block") {
+        plib::monotonic_arena arena(1024, &upstream);
+        std::byte* previous = nullptr;
+        for (int i = 0; i < 100; ++i) {
+            auto* ptr = static_cast<std::byte*>(arena.allocate(100, 1));
+            // Consecutive allocations inside a block are adjacent.
+            if (previous && upstream.allocations == 1) CHECK(ptr == previous + 100);
+            previous = ptr;
+        }
+        REQUIRE(upstream.allocations >= 3);
+        for (std::size_t i = 1; i < upstream.sizes.size(); ++i) CHECK(upstream.sizes[i] == 2 * upstream.sizes[i - 1]);
+
+        std::size_t const before = upstream.allocations;
+        void* large = arena.allocate(1 << 20, 64);
+        CHECK(is_aligned(large, 64));
+        CHECK(upstream.allocations == before + 1);
+        CHECK(upstream.sizes.back() >= (1u << 20));
+
+        // reset() keeps only the most recent block, release() returns everything.
+        arena.reset();
+        CHECK(upstream.live.size() == 1);
+        arena.allocate(100);
+        CHECK(upstream.allocations == before + 1);
+        arena.release();
+        CHECK(upstream.live.empty());
+    }
+
+    SECTION("initial buffer is used before upstream") {
+        alignas(std::max_align_t) std::byte buffer[512];
+        plib::monotonic_arena arena(buffer, sizeof(buffer), &upstream);
+        void* first = arena.allocate(100);
+        CHECK(first == buffer);
+        arena.allocate(300);
+        CHECK(upstream.allocations == 0);
+        arena.allocate(300);
+        CHECK(upstream.allocations == 1);
+        arena.reset();
+        arena.release();
+        CHECK(arena.allocate(100) == buffer);
+    }
+
+    SECTION("as a std::pmr resource") {
+        plib::monotonic_arena arena(1024, &upstream);
+        std::pmr::vector<int> values(&arena);
+        for (int i = 0; i < 10'000; ++i) values.push_back(i);
+        CHECK(values[9999] == 9999);
+    }
+    CHECK(upstream.mismatched == 0);
+}
+
+TEST_CASE("pool_resource", "[memory]") {
+    checking_resource upstream;
+
+    SECTION("freed blocks are reused") {
+        plib::pool_resource pool(24, alignof(std::max_align_t), 4, &upstream);
+        CHECK(pool.block_size() == 32);
+        void* a = pool.allocate_block();
+        void* b = pool.allocate_block();
+        CHECK(static_cast<std::byte*>(b) == static_cast<std::byte*>(a) + pool.block_size());
+        pool.deallocate_block(a);
+        CHECK(pool.allocate_block() == a);
+        CHECK(upstream.allocations == 1);
+
+        // The chunk holds 4 blocks, the 5th needs a new one.
+        pool.allocate_block();
+        pool.allocate_block();
+        CHECK(upstream.allocations == 1);
+        pool.allocate_block();
+        CHECK(upstream.allocations == 2);
+
+        pool.release();
+        CHECK(upstream.live.empty());
+    }
+
+    SECTION("over-aligned blocks") {
+        plib::pool_resource pool(8, 64, 16, &upstream);
+        CHECK(pool.block_size() == 64);
+        for (int i = 0; i < 40; ++i) CHECK(is_aligned(pool.allocate_block(), 64));
+    }
+
+    SECTION("requests that do not fit a block go upstream") {
+        plib::pool_resource pool(16, 16, 8, &upstream);
+        std::pmr::memory_resource& resource = pool;
+        void* small = resource.allocate(16, 16);
+        CHECK(upstream.allocations == 1);
+        void* large = resource.allocate(1000, 16);
+        CHECK(upstream.allocations == 2);
+        CHECK(upstream.live.count(large) == 1);
+        void* aligned = resource.allocate(16, 64);
+        CHECK(is_aligned(aligned, 64));
+        CHECK(upstream.live.count(aligned) == 1);
+        resource.deallocate(large, 1000, 16);
+        resource.deallocate(aligned, 16, 64);
+        resource.deallocate(small, 16, 16);
+        CHECK(resource.allocate(16, 16) == small);
+    }
+    CHECK(upstream.mismatched == 0);
+}
+
+TEST_CASE("object_pool constructs and destroys objects", "[memory]") {
+    checking_resource upstream;
+    {
+        plib::object_pool<counted> pool(8, &upstream);
+        std::vector<counted*> objects;
+        for (int i = 0; i < 20; ++i) objects.push_back(pool.create(i));
+        CHECK(counted::alive == 20);
+        CHECK(objects[19]->value == 19);
+
+        counted* freed = objects[5];
+        pool.destroy(freed);
+        CHECK(counted::alive == 19);
+        counted* reused = pool.create(100);
+        CHECK(reused == freed);
+        objects[5] = reused;
+
+        // A throwing constructor gives the block back.
+        CHECK_THROWS_AS(pool.create(-1), std::invalid_argument);
+        CHECK(pool.create(7) != nullptr);
+        CHECK(counted::alive == 21);
+
+        for (counted* object : objects) pool.destroy(object);
+        pool.destroy(nullptr);
+        CHECK(counted::alive == 1);
+    }
+    counted::alive = 0;
+    CHECK(upstream.mismatched == 0);
+}
+
+TEST_CASE("allocate_unique releases through the resource it came from", "[memory]") {
+    checking_resource first;
+    checking_resource second;
+
+    {
+        plib::allocated_ptr<counted> a = plib::allocate_unique<counted>(&first, 1);
+        plib::allocated_ptr<counted> b = plib::allocate_unique<counted>(&second, 2);
+        CHECK(first.live.size() == 1);
+        CHECK(second.live.size() == 1);
+        CHECK(counted::alive == 2);
+
+        // Swapping owners must not swap resources.
+        std::swap(a, b);
+        CHECK(a->value == 2);
+    }
+    CHECK(counted::alive == 0);
+    CHECK(first.live.empty());
+    CHECK(second.live.empty());
+
+    SECTION("through a base class pointer") {
+        plib::allocated_ptr<counted> base = plib::allocate_unique<counted_derived>(&first, 3);
+        CHECK(is_aligned(base.get(), 64));
+        CHECK(first.live.begin()->second == std::pair(sizeof(counted_derived), alignof(counted_derived)));
+        base.reset();
+        CHECK(first.live.empty());
+        CHECK(counted::alive == 0);
+    }
+
+    SECTION("a throwing constructor frees the memory") {
+        CHECK_THROWS_AS(plib::allocate_unique<counted>(&first, -1), std::invalid_argument);
+        CHECK(first.live.empty());
+    }
+
+    SECTION("a deleter without resource uses delete") {
+        plib::allocated_ptr<counted> adopted(new counted(4));
+        CHECK(counted::alive == 1);
+        adopted.reset();
+        CHECK(counted::alive == 0);
+    }
+    CHECK(first.mismatched == 0);
+    CHECK(second.mismatched == 0);
+}
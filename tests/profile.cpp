@@ -0,0 +1,109 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/profile.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct string_output {
+    std::string data;
+
+    void write_bytes(plib::byte const* pointer, std::size_t n) {
+        data.append(reinterpret_cast<char const*>(pointer), n);
+    }
+};
+
+// The writer puts one event per line, so fields can be read without a JSON parser.
+std::string field(std::string_view line, std::string_view key) {
+    std::string const pattern = "\"" + std::string(key) + "\":";
+    std::size_t start = line.find(pattern);
+    if (start == std::string_view::npos) return {};
+    start += pattern.size();
+    if (line[start] == '"') {
+        std::size_t end = start + 1;
+        while (line[end] != '"') end += line[end] == '\\' ? 2 : 1;
+        return std::string(line.substr(start, end + 1 - start));
+    }
+    std::size_t const end = line.find_first_of(",}", start);
+    return std::string(line.substr(start, end - start));
+}
+
+void record_zones(char const* name, int count) {
+    for (int i = 0; i < count; ++i) {
+        plib::profile::scoped_zone zone(name);
+        plib::profile::get_counter("test counter").add(1);
+    }
+}
+
+}
+
+TEST_CASE("write_chrome_trace writes zones and counters of every thread", "[profile]") {
+    // Drop whatever earlier tests recorded.
+    string_output discard;
+    plib::profile::write_chrome_trace(discard);
+
+    plib::profile::get_counter("test \"quoted\" counter").add(3);
+    std::thread other([] { record_zones("zone on other thread", 50); });
+    record_zones("zone on main thread", 50);
+    other.join();
+
+    string_output out;
+    plib::profile::write_chrome_trace(out);
+    std::string_view const json = out.data;
+    REQUIRE(json.starts_with("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"));
+    REQUIRE(json.ends_with("\n]}\n"));
+
+    std::map<std::string, int> zones_per_name;
+    std::map<std::string, std::string> tid_of_name;
+    std::map<std::string, double> last_ts;
+    std::map<std::string, std::string> counters;
+    std::istringstream lines(out.data);
+    std::string line;
+    std::getline(lines, line);
+    while (std::getline(lines, line)) {
+        if (line == "]}") break;
+        if (line.ends_with(",")) line.pop_back();
+        REQUIRE(line.starts_with("{\"ph\":"));
+        REQUIRE(line.ends_with("}"));
+
+        std::string const ph = field(line, "ph");
+        std::string const name = field(line, "name");
+        if (ph == "\"X\"") {
+            std::string const tid = field(line, "tid");
+            double const ts = std::strtod(field(line, "ts").c_str(), nullptr);
+            CHECK(ts >= 0.0);
+            CHECK(std::strtod(field(line, "dur").c_str(), nullptr) >= 0.0);
+            // Zones that do not nest end in the order they start, so their timestamps increase per thread.
+            CHECK(ts >= last_ts[tid]);
+            last_ts[tid] = ts;
+            ++zones_per_name[name];
+            if (tid_of_name.contains(name)) CHECK(tid_of_name[name] == tid);
+            tid_of_name[name] = tid;
+        } else if (ph == "\"C\"") {
+            counters[name] = field(line, "value");
+        } else {
+            CHECK(ph == "\"M\"");
+        }
+    }
+
+    CHECK(zones_per_name["\"zone on main thread\""] == 50);
+    CHECK(zones_per_name["\"zone on other thread\""] == 50);
+    CHECK(tid_of_name["\"zone on main thread\""] != tid_of_name["\"zone on other thread\""]);
+    CHECK(counters["\"test counter\""] == "100");
+    CHECK(counters["\"test \\\"quoted\\\" counter\""] == "3");
+
+    SECTION("events are only written once") {
+        string_output again;
+        plib::profile::write_chrome_trace(again);
+        CHECK(again.data.find("zone on") == std::string::npos);
+        CHECK(again.data.find("\"test counter\"") != std::string::npos);
+    }
+}
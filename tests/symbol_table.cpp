@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/symbol_table.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("symbol_table interns strings", "[symbol_table]") {
+    plib::symbol_table table;
+    std::uint32_t const foo = table.intern("foo");
+    std::uint32_t const bar = table.intern("bar");
+    CHECK(foo == 0);
+    CHECK(bar == 1);
+    CHECK(table.intern("foo") == foo);
+    CHECK(table.intern(std::string("ba") + "r") == bar);
+    CHECK(table.find("foo") == foo);
+    CHECK(table.find("baz") == plib::invalid_symbol);
+    CHECK(table.name(foo) == "foo");
+    CHECK(std::strcmp(table.c_str(bar), "bar") == 0);
+    CHECK(table.size() == 2);
+
+    std::uint32_t const empty = table.intern("");
+    CHECK(table.name(empty).empty());
+    CHECK(table.find("") == empty);
+}
+
+TEST_CASE("symbol_table stores long strings in their own block", "[symbol_table]") {
+    plib::symbol_table table;
+    std::uint32_t const before = table.intern("before");
+    std::string const long_string(plib::detail::string_arena::block_size * 2 + 17, 'x');
+    std::uint32_t const big = table.intern(long_string);
+    std::uint32_t const after = table.intern("after");
+
+    CHECK(table.name(big) == long_string);
+    CHECK(table.c_str(big)[long_string.size()] == '\0');
+    CHECK(table.intern(long_string) == big);
+    CHECK(table.name(before) == "before");
+    CHECK(table.name(after) == "after");
+
+    // Short strings keep filling the regular blocks after the spill.
+    for (int i = 0; i < 1000; ++i) {
+        std::string const str = "short_" + std::to_string(i);
+        REQUIRE(table.name(table.intern(str)) == str);
+    }
+    CHECK(table.name(big) == long_string);
+}
+
+TEST_CASE("symbol_table grows the id table across segments", "[symbol_table]") {
+    plib::symbol_table table;
+    // The first segments hold 1024, 2048, 4096 and 8192 entries.
+    constexpr std::uint32_t count = 20'000;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        REQUIRE(table.intern("symbol_" + std::to_string(i)) == i);
+    }
+    CHECK(table.size() == count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        REQUIRE(table.name(i) == "symbol_" + std::to_string(i));
+        REQUIRE(table.find(table.name(i)) == i);
+    }
+}
+
+TEST_CASE("symbol_table interns the same strings from several threads", "[symbol_table]") {
+    plib::symbol_table table;
+    constexpr std::size_t thread_count = 4;
+    constexpr std::size_t string_count = 5000;
+
+    std::vector<std::string> strings;
+    for (std::size_t i = 0; i < string_count; ++i) strings.push_back("name_" + std::to_string(i * 7919));
+
+    std::vector<std::vector<std::uint32_t>> symbols(thread_count, std::vector<std::uint32_t>(string_count));
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            // Every thread walks the strings from a different start and direction, so they race on first insertion.
+            for (std::size_t n = 0; n < string_count; ++n) {
+                std::size_t const step = t % 2 == 0 ? n : string_count - 1 - n;
+                std::size_t const i = (step + t * 1000) % string_count;
+                symbols[t][i] = table.intern(strings[i]);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    CHECK(table.size() == string_count);
+    std::vector<bool> seen(string_count);
+    for (std::size_t i = 0; i < string_count; ++i) {
+        std::uint32_t const symbol = symbols[0][i];
+        for (std::size_t t = 1; t < thread_count; ++t) REQUIRE(symbols[t][i] == symbol);
+        REQUIRE(symbol < string_count);
+        REQUIRE_FALSE(seen[symbol]);
+        seen[symbol] = true;
+        REQUIRE(table.name(symbol) == strings[i]);
+    }
+}
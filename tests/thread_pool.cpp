@@ -0,0 +1,108 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/thread_pool.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+int square(int x) {
+    return x * x;
+}
+
+}
+
+TEST_CASE("thread_pool runs submitted tasks", "[thread_pool]") {
+    plib::thread_pool pool(4);
+
+    std::vector<plib::task_handle<int>> handles;
+    for (int i = 0; i < 1000; ++i) {
+        handles.push_back(pool.submit([i] { return i * 2; }));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(handles[i].get() == i * 2);
+    }
+
+    SECTION("exceptions are rethrown by get") {
+        auto handle = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+        CHECK_THROWS_AS(handle.get(), std::runtime_error);
+    }
+
+    SECTION("erased functions") {
+        auto function = plib::make_function<int>(&square);
+        CHECK(pool.submit(*function, 7).get() == 49);
+    }
+}
+
+TEST_CASE("thread_pool parallel_for visits every index once", "[thread_pool]") {
+    plib::thread_pool pool(4);
+
+    for (std::size_t grain : { std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(10'000) }) {
+        std::vector<std::atomic<int>> visits(5000);
+        pool.parallel_for(0, visits.size(), [&](std::size_t i) { visits[i].fetch_add(1, std::memory_order_relaxed); }, grain);
+        for (auto const& count : visits) CHECK(count.load() == 1);
+    }
+
+    // Empty ranges do nothing.
+    pool.parallel_for(10, 10, [](std::size_t) { FAIL("called for an empty range"); });
+
+    SECTION("the first exception is rethrown after every chunk finished") {
+        std::atomic<int> calls = 0;
+        CHECK_THROWS_AS(pool.parallel_for(0, 100, [&](std::size_t i) {
+            calls.fetch_add(1);
+            if (i % 10 == 0) throw std::runtime_error("body failed");
+        }, 1), std::runtime_error);
+        CHECK(calls.load() == 100);
+    }
+}
+
+TEST_CASE("thread_pool stress: many short parallel_for calls", "[thread_pool]") {
+    // Returning from parallel_for as soon as the last chunk finishes used to race with that chunk still notifying the caller.
+    plib::thread_pool pool(4);
+    for (int round = 0; round < 2000; ++round) {
+        std::atomic<std::size_t> sum = 0;
+        pool.parallel_for(0, 16, [&](std::size_t i) { sum.fetch_add(i, std::memory_order_relaxed); }, 1);
+        REQUIRE(sum.load() == 120);
+    }
+}
+
+TEST_CASE("thread_pool stress: nested submits and waits", "[thread_pool]") {
+    // Tasks that submit and wait on more tasks must not deadlock, even with more waiting tasks than workers.
+    plib::thread_pool pool(2);
+
+    std::vector<plib::task_handle<std::size_t>> outer;
+    for (std::size_t i = 0; i < 64; ++i) {
+        outer.push_back(pool.submit([&pool, i] {
+            std::vector<plib::task_handle<std::size_t>> inner;
+            for (std::size_t j = 0; j < 16; ++j) {
+                inner.push_back(pool.submit([i, j] { return i * j; }));
+            }
+            std::size_t total = 0;
+            for (auto& handle : inner) total += handle.get();
+
+            std::atomic<std::size_t> nested = 0;
+            pool.parallel_for(0, 32, [&](std::size_t k) { nested.fetch_add(k, std::memory_order_relaxed); }, 4);
+            return total + nested.load();
+        }));
+    }
+
+    for (std::size_t i = 0; i < outer.size(); ++i) {
+        CHECK(outer[i].get() == i * 120 + 496);
+    }
+}
+
+TEST_CASE("thread_pool finishes queued tasks on destruction", "[thread_pool]") {
+    std::atomic<int> done = 0;
+    {
+        plib::thread_pool pool(3);
+        for (int i = 0; i < 500; ++i) {
+            // Handles are dropped right away, the pool still owns the tasks.
+            pool.submit([&done] { done.fetch_add(1); });
+        }
+    }
+    CHECK(done.load() == 500);
+}
@@ -0,0 +1,63 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/traits.hpp>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+using free_function = int(double, char const*);
+using noexcept_function = void(int) noexcept;
+
+struct object {
+    long member(int, int);
+    bool const_member() const;
+    void noexcept_member() noexcept;
+
+    std::string operator()(std::string const&) const;
+};
+
+using free_traits = plib::function_traits<free_function*>;
+static_assert(std::is_same_v<free_traits::return_type, int>);
+static_assert(std::is_same_v<free_traits::argument_types, plib::pack<double, char const*>>);
+static_assert(free_traits::arity == 2);
+
+static_assert(std::is_same_v<plib::function_traits<free_function>::return_type, int>);
+static_assert(plib::function_traits<noexcept_function*>::arity == 1);
+
+using member_traits = plib::function_traits<decltype(&object::member)>;
+static_assert(std::is_same_v<member_traits::return_type, long>);
+static_assert(std::is_same_v<member_traits::argument_types, plib::pack<int, int>>);
+static_assert(std::is_same_v<member_traits::class_type, object>);
+static_assert(std::is_same_v<plib::function_traits<decltype(&object::const_member)>::class_type, object const>);
+static_assert(std::is_same_v<plib::function_traits<decltype(&object::noexcept_member)>::class_type, object>);
+
+// Function objects and lambdas go through their operator().
+static_assert(std::is_same_v<plib::function_traits<object>::argument_types, plib::pack<std::string const&>>);
+inline auto const lambda = [](int x, float y) { return x * y; };
+static_assert(std::is_same_v<plib::function_traits<decltype(lambda)>::return_type, float>);
+static_assert(plib::function_traits<decltype(lambda)>::arity == 2);
+
+static_assert(std::is_same_v<plib::make_pack<3, int>::type, plib::pack<int, int, int>>);
+
+enum class small : std::int8_t { a = -100, b = 100 };
+
+}
+
+template<>
+struct plib::enum_range<small> {
+    static constexpr std::int8_t min = -100;
+    static constexpr std::int8_t max = 100;
+};
+
+TEST_CASE("enum_index and enum_from_index are inverses", "[traits]") {
+    static_assert(plib::enum_size_v<small> == 201);
+    // Indices above the range of the underlying type still map back to the right enumerator.
+    for (std::size_t i = 0; i < plib::enum_size_v<small>; ++i) {
+        small const e = plib::enum_from_index<small>(i);
+        REQUIRE(static_cast<int>(e) == static_cast<int>(i) - 100);
+        REQUIRE(plib::enum_index(e) == i);
+    }
+}
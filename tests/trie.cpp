@@ -0,0 +1,185 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/memory.hpp>
+#include <plib/trie.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::size_t levenshtein(std::string const& a, std::string const& b) {
+    std::vector<std::size_t> row(b.size() + 1);
+    for (std::size_t j = 0; j <= b.size(); ++j) row[j] = j;
+    for (std::size_t i = 1; i <= a.size(); ++i) {
+        std::size_t diagonal = row[0];
+        row[0] = i;
+        for (std::size_t j = 1; j <= b.size(); ++j) {
+            std::size_t const above = row[j];
+            row[j] = std::min({ row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1) });
+            diagonal = above;
+        }
+    }
+    return row[b.size()];
+}
+
+std::vector<std::string> random_words(std::size_t count, std::uint64_t seed) {
+    // A small alphabet so words share prefixes and many of them are close to each other.
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<std::size_t> length(1, 7);
+    std::uniform_int_distribution<int> letter('a', 'e');
+    std::vector<std::string> words;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string word(length(rng), ' ');
+        for (char& c : word) c = static_cast<char>(letter(rng));
+        words.push_back(word);
+    }
+    return words;
+}
+
+}
+
+TEST_CASE("trie stores and finds keys", "[trie]") {
+    plib::trie<std::string, int> trie;
+    trie.insert("hello", 1);
+    trie.insert("help", 2);
+    trie.insert("he", 3);
+    trie.insert("h", 4);
+    trie.insert("", 5);
+
+    CHECK(trie.get("hello") == 1);
+    CHECK(trie.get("help") == 2);
+    CHECK(trie.get("he") == 3);
+    CHECK(trie.get("h") == 4);
+    CHECK_FALSE(trie.contains("hel"));
+    CHECK_FALSE(trie.contains("helpful"));
+    CHECK_FALSE(trie.contains(""));
+
+    trie.insert("help", 6);
+    CHECK(trie.get("help") == 6);
+
+    SECTION("collect keys") {
+        std::vector<std::string> all = trie.collect_all_keys();
+        std::sort(all.begin(), all.end());
+        CHECK(all == std::vector<std::string> { "h", "he", "hello", "help" });
+
+        std::vector<std::string> hel = trie.collect_with_prefix("hel");
+        std::sort(hel.begin(), hel.end());
+        CHECK(hel == std::vector<std::string> { "hello", "help" });
+
+        CHECK(trie.collect_with_prefix("x").empty());
+        CHECK(trie.collect_with_prefix("hex").empty());
+    }
+
+    SECTION("prefixes of a text") {
+        auto const matches = trie.prefixes_of("hello world");
+        REQUIRE(matches.size() == 3);
+        CHECK(matches[0].length == 1);
+        CHECK(matches[1].length == 2);
+        CHECK(matches[2].length == 5);
+        CHECK(*matches[2].value == 1);
+
+        auto const longest = trie.longest_prefix_of("helpers");
+        REQUIRE(longest);
+        CHECK(longest->length == 4);
+        CHECK(*longest->value == 6);
+        CHECK_FALSE(trie.longest_prefix_of("xyz"));
+    }
+}
+
+TEST_CASE("trie handles long keys without recursing per character", "[trie]") {
+    plib::trie<std::string, int> trie;
+    std::string const key(200'000, 'a');
+    trie.insert(key, 1);
+    trie.insert(key + 'b', 2);
+    CHECK(trie.get(key) == 1);
+    CHECK(trie.get(key + 'b') == 2);
+    CHECK_FALSE(trie.contains(key.substr(1)));
+
+    std::vector<std::string> keys = trie.collect_all_keys();
+    std::sort(keys.begin(), keys.end());
+    REQUIRE(keys.size() == 2);
+    CHECK(keys[0] == key);
+    CHECK(keys[1] == key + 'b');
+
+    std::vector<std::string> const with_prefix = trie.collect_with_prefix(key);
+    CHECK(with_prefix.size() == 2);
+    CHECK(trie.collect_with_prefix(key + 'b') == std::vector<std::string>{ key + 'b' });
+}
+
+TEST_CASE("trie collects keys along sibling chains", "[trie]") {
+    plib::trie<std::string, int> trie;
+    // Inserted in descending order so each key hangs off the left link of the previous one.
+    for (std::string const key : { "ad", "ac", "ab", "aa", "ae", "acx", "abyz" }) trie.insert(key, 0);
+
+    std::vector<std::string> keys = trie.collect_all_keys();
+    std::sort(keys.begin(), keys.end());
+    CHECK(keys == std::vector<std::string>{ "aa", "ab", "abyz", "ac", "acx", "ad", "ae" });
+
+    keys = trie.collect_with_prefix("ab");
+    std::sort(keys.begin(), keys.end());
+    CHECK(keys == std::vector<std::string>{ "ab", "abyz" });
+}
+
+TEST_CASE("moved-from trie stays usable", "[trie]") {
+    plib::trie<std::string, int> a;
+    a.insert("key", 1);
+
+    plib::trie<std::string, int> b = std::move(a);
+    CHECK(b.get("key") == 1);
+    CHECK_FALSE(a.contains("key"));
+    a.insert("other", 2);
+    CHECK(a.get("other") == 2);
+
+    a = std::move(b);
+    CHECK(a.get("key") == 1);
+    CHECK_FALSE(a.contains("other"));
+    CHECK(b.collect_all_keys().empty());
+}
+
+TEST_CASE("trie allocates nodes from a memory resource", "[trie]") {
+    plib::pool_resource pool(plib::trie<std::string, int>::node_size(), alignof(std::max_align_t));
+    plib::trie<std::string, int> trie({}, &pool);
+    std::vector<std::string> const words = random_words(500, 7);
+    for (std::size_t i = 0; i < words.size(); ++i) trie.insert(words[i], static_cast<int>(i));
+    for (std::string const& word : words) CHECK(trie.contains(word));
+}
+
+TEST_CASE("fuzzy_search matches brute force Levenshtein", "[trie]") {
+    std::vector<std::string> const words = random_words(400, 42);
+    std::map<std::string, int> reference;
+    plib::trie<std::string, int> trie;
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        trie.insert(words[i], static_cast<int>(i));
+        reference[words[i]] = static_cast<int>(i);
+    }
+
+    std::vector<std::string> queries = random_words(50, 1234);
+    queries.push_back("");
+    queries.push_back(words.front());
+
+    for (std::size_t max_distance = 0; max_distance <= 2; ++max_distance) {
+        for (std::string const& query : queries) {
+            std::map<std::string, std::size_t> expected;
+            for (auto const& [key, value] : reference) {
+                std::size_t const distance = levenshtein(query, key);
+                if (distance <= max_distance) expected[key] = distance;
+            }
+
+            std::map<std::string, std::size_t> found;
+            for (auto const& match : trie.fuzzy_search(query, max_distance)) {
+                CHECK(found.count(match.key) == 0);
+                found[match.key] = match.distance;
+                REQUIRE(match.value);
+                CHECK(*match.value == reference.at(match.key));
+            }
+
+            INFO("query '" << query << "', max distance " << max_distance);
+            CHECK(found == expected);
+        }
+    }
+}
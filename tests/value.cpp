@@ -0,0 +1,175 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <plib/erased_function.hpp>
+#include <plib/value.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+using plib::value;
+
+TEST_CASE("value round-trips integers", "[value]") {
+    for (std::int64_t i : { std::int64_t(0), std::int64_t(1), std::int64_t(-1), value::int_min, value::int_max }) {
+        value const v(i);
+        CHECK(v.is_int());
+        CHECK(static_cast<std::int64_t>(v) == i);
+    }
+
+    SECTION("integers outside of 48 bits are stored as doubles") {
+        value const above(value::int_max + 1);
+        CHECK(above.is_number());
+        CHECK(static_cast<std::int64_t>(above) == value::int_max + 1);
+
+        value const below(value::int_min - 1);
+        CHECK(below.is_number());
+        CHECK(static_cast<std::int64_t>(below) == value::int_min - 1);
+
+        value const large(std::numeric_limits<std::uint64_t>::max());
+        CHECK(large.is_number());
+    }
+}
+
+TEST_CASE("value rejects conversions to integers that do not fit", "[value]") {
+    CHECK(static_cast<std::int8_t>(value(-128)) == -128);
+    CHECK(static_cast<std::uint8_t>(value(255)) == 255);
+    CHECK_THROWS_AS(static_cast<std::int8_t>(value(128)), plib::bad_value_access);
+    CHECK_THROWS_AS(static_cast<std::uint32_t>(value(-1)), plib::bad_value_access);
+
+    CHECK(static_cast<int>(value(-2.75)) == -2);
+    CHECK(static_cast<std::uint8_t>(value(255.5)) == 255);
+    CHECK(static_cast<std::int64_t>(value(-9223372036854775808.0)) == std::numeric_limits<std::int64_t>::min());
+    CHECK_THROWS_AS(static_cast<int>(value(1e20)), plib::bad_value_access);
+    CHECK_THROWS_AS(static_cast<std::int64_t>(value(9223372036854775808.0)), plib::bad_value_access);
+    CHECK_THROWS_AS(static_cast<std::uint64_t>(value(-1.0)), plib::bad_value_access);
+    CHECK_THROWS_AS(static_cast<int>(value(std::numeric_limits<double>::quiet_NaN())), plib::bad_value_access);
+    CHECK_THROWS_AS(static_cast<int>(value(std::numeric_limits<double>::infinity())), plib::bad_value_access);
+
+    // Floating point targets accept any number.
+    CHECK(static_cast<double>(value(1e20)) == 1e20);
+}
+
+TEST_CASE("value round-trips doubles", "[value]") {
+    for (double d : { 0.0, -0.0, 1.5, -2.25, std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+                      std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::infinity(),
+                      -std::numeric_limits<double>::infinity() }) {
+        value const v(d);
+        CHECK(v.is_number());
+        CHECK(static_cast<double>(v) == d);
+    }
+
+    SECTION("NaN stays a number") {
+        value const nan(std::numeric_limits<double>::quiet_NaN());
+        CHECK(nan.is_number());
+        CHECK(std::isnan(static_cast<double>(nan)));
+
+        // A negative quiet NaN has the bit pattern of a boxed value, it must still be canonicalized.
+        value const negative_nan(-std::numeric_limits<double>::quiet_NaN());
+        CHECK(negative_nan.is_number());
+        CHECK(std::isnan(static_cast<double>(negative_nan)));
+    }
+}
+
+TEST_CASE("value stores booleans, nil and pointers", "[value]") {
+    CHECK(value().is_nil());
+    CHECK(value(nullptr).is_nil());
+    CHECK(static_cast<bool>(value(true)));
+    CHECK_FALSE(static_cast<bool>(value(false)));
+
+    int x = 0;
+    value const p(&x);
+    CHECK(p.is_pointer());
+    CHECK(static_cast<int*>(p) == &x);
+    CHECK(static_cast<int*>(value()) == nullptr);
+
+    CHECK_THROWS_AS(static_cast<bool>(value(1)), plib::bad_value_access);
+    CHECK_THROWS_AS(static_cast<int>(value(true)), plib::bad_value_access);
+    CHECK_THROWS_AS(static_cast<int*>(value(1)), plib::bad_value_access);
+}
+
+TEST_CASE("value stores strings", "[value]") {
+    SECTION("small strings") {
+        for (std::string_view str : { "", "a", "abcd", "abcde" }) {
+            value const v(str);
+            CHECK(v.is_string());
+            CHECK(static_cast<std::string_view>(v) == str);
+            CHECK(std::string_view(v.c_str()) == str);
+        }
+        CHECK_THROWS_AS(value(std::string_view("abcdef")), std::length_error);
+        CHECK_THROWS_AS(value(std::string_view("a\0b", 3)), std::invalid_argument);
+    }
+
+    SECTION("interned strings") {
+        static char const text[] = "a string that does not fit inline";
+        value const v = value::interned_string(text);
+        CHECK(v.is_string());
+        CHECK(static_cast<std::string>(v) == text);
+        CHECK(v.c_str() == text);
+        CHECK_FALSE(v == value("a str"));
+    }
+
+    SECTION("every spelling of a literal stores a string") {
+        value const copy_initialized = "abc";
+        CHECK(copy_initialized.is_string());
+        CHECK(static_cast<std::string>(copy_initialized) == "abc");
+        CHECK(copy_initialized == value("abc"));
+
+        char buffer[] = "xyz";
+        value const from_mutable = buffer;
+        CHECK(from_mutable.is_string());
+        CHECK(static_cast<std::string_view>(from_mutable) == "xyz");
+    }
+
+    SECTION("equality compares contents") {
+        static char const text[] = "abc";
+        CHECK(value("abc") == value::interned_string(text));
+        CHECK(value(1) == value(1.0));
+        CHECK_FALSE(value(1) == value(true));
+    }
+}
+
+namespace {
+
+std::string last_string;
+
+void take_string(std::string const& str) {
+    last_string = str;
+}
+
+std::size_t c_string_length(char const* str) {
+    return std::string_view(str).size();
+}
+
+int twice(int x) {
+    return 2 * x;
+}
+
+}
+
+TEST_CASE("value binds to parameters of erased functions", "[value][erased_function]") {
+    SECTION("std::string const&") {
+        auto* function = plib::make_concrete_function<value>(&take_string, [](auto&&) { return value(); });
+        static char const text[] = "interned text";
+        function->call_void(value("hi"));
+        CHECK(last_string == "hi");
+        function->call_void(value::interned_string(text));
+        CHECK(last_string == text);
+        CHECK_THROWS_AS(function->call_void(value(1)), plib::bad_value_access);
+        delete function;
+    }
+
+    SECTION("char const*") {
+        auto function = plib::make_function<value>(&c_string_length);
+        CHECK(static_cast<std::size_t>(function->call(value("abcde"))) == 5);
+        CHECK(static_cast<std::size_t>(function->call(value(""))) == 0);
+        CHECK_THROWS_AS(function->call(value(1)), plib::bad_value_access);
+    }
+
+    SECTION("numbers out of range of an int parameter") {
+        auto function = plib::make_function<value>(&twice);
+        CHECK(static_cast<int>(function->call(value(21.0))) == 42);
+        CHECK_THROWS_AS(function->call(value(1e20)), plib::bad_value_access);
+    }
+}